@@ -0,0 +1,62 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <new>
+
+#include <stdlib.h>
+
+static std::atomic<uint64_t> allocationCount(0);
+static std::atomic<uint64_t> allocatedBytes(0);
+
+static void* countedAlloc(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    void *ptr = malloc(size ? size : 1);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(size_t size) {
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size) {
+    return countedAlloc(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    free(ptr);
+}
+
+namespace AllocationCounter {
+
+uint64_t allocations() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+uint64_t bytes() {
+    return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+} // namespace AllocationCounter
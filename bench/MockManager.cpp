@@ -0,0 +1,133 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MockManager.h"
+
+using namespace pbnjson;
+using namespace EventMonitor;
+
+MockManager::MockManager() :
+        mNowMs(0), mRecording(false), mToasts(0), mAlerts(0), mClosedAlerts(0), mTimeouts(
+                0) {
+}
+
+void MockManager::subscribeToMethod(const std::string &subscriptionId,
+        const std::string &methodPath, const JValue &params,
+        SubscriptionCallback callback) {
+    mSubscriptions[subscriptionId] = callback;
+}
+
+void MockManager::unsubscribeFromMethod(const std::string &subscriptionId) {
+    mSubscriptions.erase(subscriptionId);
+}
+
+void MockManager::setTimeout(const std::string &timeoutId, unsigned int timeMs,
+        bool repeat, TimeoutCallback callback) {
+    //Like the real manager, a timeout with the same id is replaced
+    mTimeoutsById[timeoutId] = { mNowMs + timeMs, timeMs, repeat, callback };
+}
+
+void MockManager::cancelTimeout(const std::string &timeoutId) {
+    mTimeoutsById.erase(timeoutId);
+}
+
+void MockManager::createToast(const std::string &message,
+        const std::string &iconUrl, const JValue &onClickAction) {
+    mToasts++;
+    record(CALL_TOAST, "", message);
+}
+
+void MockManager::createAlert(const std::string &alertId,
+        const std::string &title, const std::string &message, bool modal,
+        const std::string &iconPath, const JValue &buttons,
+        const JValue &onClose) {
+    mAlerts++;
+    record(CALL_ALERT, alertId, message);
+}
+
+void MockManager::closeAlert(const std::string &alertId) {
+    mClosedAlerts++;
+    record(CALL_CLOSE_ALERT, alertId, "");
+}
+
+void MockManager::registerMethod(const std::string &category,
+        const std::string &methodName, LunaCallback callback, JValue schema) {
+    mMethods[methodName] = callback;
+}
+
+bool MockManager::publish(const std::string &subscriptionId,
+        JValue &previousValue, JValue &value) {
+    auto iter = mSubscriptions.find(subscriptionId);
+    if (iter == mSubscriptions.end())
+        return false;
+
+    iter->second(previousValue, value);
+    return true;
+}
+
+JValue MockManager::callMethod(const std::string &methodName, JValue &params) {
+    auto iter = mMethods.find(methodName);
+    if (iter == mMethods.end())
+        return JValue();
+
+    return iter->second(params);
+}
+
+void MockManager::advance(uint64_t ms) {
+    uint64_t targetMs = mNowMs + ms;
+
+    for (;;) {
+        auto due = mTimeoutsById.end();
+        for (auto iter = mTimeoutsById.begin(); iter != mTimeoutsById.end();
+                ++iter) {
+            if (iter->second.dueMs <= targetMs
+                    && (due == mTimeoutsById.end()
+                            || iter->second.dueMs < due->second.dueMs))
+                due = iter;
+        }
+        if (due == mTimeoutsById.end())
+            break;
+
+        std::string timeoutId = due->first;
+        Timeout timeout = due->second;
+        mNowMs = timeout.dueMs;
+        if (timeout.repeat)
+            due->second.dueMs += timeout.intervalMs ? timeout.intervalMs : 1;
+        else
+            mTimeoutsById.erase(due);
+
+        //The callback may set or cancel timeouts, iterators are not kept
+        mTimeouts++;
+        timeout.callback(timeoutId);
+    }
+
+    mNowMs = targetMs;
+}
+
+uint64_t MockManager::nextTimeoutMs() const {
+    uint64_t next = 0;
+    for (const auto &timeout : mTimeoutsById) {
+        if (!next || timeout.second.dueMs < next)
+            next = timeout.second.dueMs;
+    }
+    return next;
+}
+
+void MockManager::record(CallType type, const std::string &id,
+        const std::string &message) {
+    if (mRecording)
+        mCalls.push_back( { mNowMs, type, id, message });
+}
@@ -0,0 +1,128 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <event-monitor-api/pluginbase.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+/*
+ * In-process stand-in for the event monitor. Subscriptions, timeouts and
+ * luna methods are kept so they can be driven by hand, timeouts run on a
+ * virtual clock that only moves in advance(). Toasts and alerts are
+ * counted, and stored when recording is on.
+ */
+class MockManager: public EventMonitor::Manager {
+public:
+    enum CallType {
+        CALL_TOAST, CALL_ALERT, CALL_CLOSE_ALERT
+    };
+
+    struct Call {
+        uint64_t timeMs;
+        CallType type;
+        std::string id;
+        std::string message;
+    };
+
+    MockManager();
+
+    void subscribeToMethod(const std::string &subscriptionId,
+            const std::string &methodPath, const pbnjson::JValue &params,
+            EventMonitor::SubscriptionCallback callback) override;
+    void unsubscribeFromMethod(const std::string &subscriptionId) override;
+    void setTimeout(const std::string &timeoutId, unsigned int timeMs,
+            bool repeat, EventMonitor::TimeoutCallback callback) override;
+    void cancelTimeout(const std::string &timeoutId) override;
+    void createToast(const std::string &message, const std::string &iconUrl,
+            const pbnjson::JValue &onClickAction) override;
+    void createAlert(const std::string &alertId, const std::string &title,
+            const std::string &message, bool modal,
+            const std::string &iconPath, const pbnjson::JValue &buttons,
+            const pbnjson::JValue &onClose) override;
+    void closeAlert(const std::string &alertId) override;
+    void registerMethod(const std::string &category,
+            const std::string &methodName, EventMonitor::LunaCallback callback,
+            pbnjson::JValue schema) override;
+
+    // Delivers a subscription response, false if nobody subscribed
+    bool publish(const std::string &subscriptionId,
+            pbnjson::JValue &previousValue, pbnjson::JValue &value);
+    // Calls a registered luna method
+    pbnjson::JValue callMethod(const std::string &methodName,
+            pbnjson::JValue &params);
+
+    // Moves the virtual clock, firing due timeouts in order
+    void advance(uint64_t ms);
+    uint64_t nowMs() const {
+        return mNowMs;
+    }
+    // Time of the next pending timeout, 0 if none
+    uint64_t nextTimeoutMs() const;
+
+    void setRecording(bool recording) {
+        mRecording = recording;
+    }
+    const std::vector<Call>& calls() const {
+        return mCalls;
+    }
+    void clearCalls() {
+        mCalls.clear();
+    }
+
+    uint64_t toasts() const {
+        return mToasts;
+    }
+    uint64_t alerts() const {
+        return mAlerts;
+    }
+    uint64_t closedAlerts() const {
+        return mClosedAlerts;
+    }
+    uint64_t timeouts() const {
+        return mTimeouts;
+    }
+    uint64_t subscriptions() const {
+        return mSubscriptions.size();
+    }
+
+private:
+    struct Timeout {
+        uint64_t dueMs;
+        unsigned int intervalMs;
+        bool repeat;
+        EventMonitor::TimeoutCallback callback;
+    };
+
+    void record(CallType type, const std::string &id,
+            const std::string &message);
+
+    std::map<std::string, EventMonitor::SubscriptionCallback> mSubscriptions;
+    std::map<std::string, Timeout> mTimeoutsById;
+    std::map<std::string, EventMonitor::LunaCallback> mMethods;
+    std::vector<Call> mCalls;
+    uint64_t mNowMs;
+    bool mRecording;
+    uint64_t mToasts;
+    uint64_t mAlerts;
+    uint64_t mClosedAlerts;
+    uint64_t mTimeouts;
+};
@@ -0,0 +1,410 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PdmPluginBench.h"
+
+#include "AllocationCounter.h"
+#include "config.h"
+#include "DeviceListDecoder.h"
+#include "DeviceListDiff.h"
+#include "MessageTemplate.h"
+#include "PdmEventCodec.h"
+#include "PdmEventParser.h"
+
+#include <string.h>
+
+using namespace pbnjson;
+using namespace PdmUtils;
+
+//Long enough for the boot toast block and any toast coalescing window
+static const uint64_t SETTLE_TIME_MS = 60000;
+
+static const int DEVICE_COUNTS[] = { 1, 4, 16, 64, 128, 256 };
+
+struct BenchEvent {
+    const char *name;
+    const char *json;
+    std::vector<std::pair<int, std::string>> fields;
+};
+
+static std::string int32Field(int32_t value) {
+    return std::string((const char*) &value, sizeof(value));
+}
+
+//Indexed by PdmEventType
+static const std::vector<BenchEvent>& benchEvents() {
+    static const std::string deviceType = int32Field(STORAGE_DEVICE);
+    static const std::vector<BenchEvent> events = {
+            { "connecting",
+                    R"({"pdmEvent":0,"parameters":{"deviceType":0}})",
+                    { { PDM_FIELD_DEVICE_TYPE, deviceType } } },
+            { "maxCountReached", R"({"pdmEvent":1,"parameters":{}})", { } },
+            { "removeBeforeMount",
+                    R"({"pdmEvent":2,"parameters":{"deviceNum":"1"}})",
+                    { { PDM_FIELD_DEVICE_NUM, "1" } } },
+            { "removeBeforeMountMtp",
+                    R"({"pdmEvent":3,"parameters":{"driveName":"sdb"}})",
+                    { { PDM_FIELD_DRIVE_NAME, "sdb" } } },
+            { "unsupportedFsFormatNeeded",
+                    R"({"pdmEvent":4,"parameters":{"deviceNum":"1"}})",
+                    { { PDM_FIELD_DEVICE_NUM, "1" } } },
+            { "fsckTimedOut",
+                    R"({"pdmEvent":5,"parameters":{"deviceNum":"1","mountName":"sda1"}})",
+                    { { PDM_FIELD_DEVICE_NUM, "1" },
+                            { PDM_FIELD_MOUNT_NAME, "sda1" } } },
+            { "formatStarted",
+                    R"({"pdmEvent":6,"parameters":{"driveInfo":"USB Drive sda1"}})",
+                    { { PDM_FIELD_DRIVE_INFO, "USB Drive sda1" } } },
+            { "formatSuccess",
+                    R"({"pdmEvent":7,"parameters":{"driveInfo":"USB Drive sda1"}})",
+                    { { PDM_FIELD_DRIVE_INFO, "USB Drive sda1" } } },
+            { "formatFail",
+                    R"({"pdmEvent":8,"parameters":{"driveInfo":"USB Drive sda1"}})",
+                    { { PDM_FIELD_DRIVE_INFO, "USB Drive sda1" } } },
+            { "removeUnsupportedFs",
+                    R"({"pdmEvent":9,"parameters":{"deviceNum":"1"}})",
+                    { { PDM_FIELD_DEVICE_NUM, "1" } } } };
+    return events;
+}
+
+//Parameter names by PdmEventField
+static const char *const fieldNames[] = { "", "deviceType", "deviceNum",
+        "driveName", "mountName", "driveInfo" };
+
+//The JDomParser path handlePdmEvent took before the SAX parser, kept as
+//the baseline for decode/json and decode/binary
+static bool decodeDom(const std::string &json, const BenchEvent &event,
+        std::vector<std::string> &values) {
+    JDomParser parser;
+    if (!parser.parse(json, JSchema::AllSchema()))
+        return false;
+
+    JValue eventObject = parser.getDom();
+    if (!eventObject.hasKey("pdmEvent") || !eventObject.hasKey("parameters"))
+        return false;
+
+    JValue params = eventObject["parameters"];
+    values.clear();
+    values.push_back(std::to_string(eventObject["pdmEvent"].asNumber<int>()));
+    for (const auto &field : event.fields) {
+        const char *name = fieldNames[field.first];
+        if (!params.hasKey(name))
+            return false;
+        if (field.first == PDM_FIELD_DEVICE_TYPE)
+            values.push_back(std::to_string(params[name].asNumber<int>()));
+        else
+            values.push_back(params[name].asString());
+    }
+    return true;
+}
+
+static const char* listName(EventType type) {
+    return (type == ATTACHED_STORAGE_DEVICE_LIST) ? "storage" : "nonStorage";
+}
+
+static const char* subscriptionId(EventType type) {
+    return (type == ATTACHED_STORAGE_DEVICE_LIST) ?
+            "attachedStorageDeviceList" : "attachedNonStorageDeviceList";
+}
+
+PdmPluginBench::PdmPluginBench(uint64_t iterations, const std::string &filter) :
+        mIterations(iterations), mFilter(filter), mMainLoopNs(0) {
+}
+
+void PdmPluginBench::runAll() {
+    benchPdmEvents();
+    benchDecoders();
+    benchDeviceLists(ATTACHED_STORAGE_DEVICE_LIST);
+    benchDeviceLists(ATTACHED_NONSTORAGE_DEVICE_LIST);
+    benchListWorker(ATTACHED_STORAGE_DEVICE_LIST);
+    benchListWorker(ATTACHED_NONSTORAGE_DEVICE_LIST);
+    benchStorms();
+    benchDiff();
+    benchFormat();
+}
+
+JValue PdmPluginBench::results() const {
+    JValue benchmarks = JArray { };
+    for (const auto &result : mResults) {
+        JValue benchmark = JObject { { "name", result.name }, { "iterations",
+                (int64_t) result.iterations }, { "nsPerOp", result.nsPerOp }, {
+                "allocationsPerOp", result.allocationsPerOp }, { "bytesPerOp",
+                result.bytesPerOp } };
+        if (result.mainLoopNsPerOp >= 0)
+            benchmark.put("mainLoopNsPerOp", result.mainLoopNsPerOp);
+        benchmarks.append(benchmark);
+    }
+    return JObject { { "benchmarks", benchmarks } };
+}
+
+std::unique_ptr<PdmPlugin> PdmPluginBench::startPlugin(MockManager &manager) {
+    std::unique_ptr<PdmPlugin> plugin(new PdmPlugin(&manager, [&manager] {
+        return manager.nowMs();
+    }));
+    plugin->startMonitoring();
+
+    JValue previousValue;
+    JValue storage = makeDeviceList(ATTACHED_STORAGE_DEVICE_LIST, 0);
+    JValue nonStorage = makeDeviceList(ATTACHED_NONSTORAGE_DEVICE_LIST, 0);
+    manager.publish(subscriptionId(ATTACHED_STORAGE_DEVICE_LIST), previousValue,
+            storage);
+    manager.publish(subscriptionId(ATTACHED_NONSTORAGE_DEVICE_LIST),
+            previousValue, nonStorage);
+    manager.advance(SETTLE_TIME_MS);
+    return plugin;
+}
+
+void PdmPluginBench::handlePdmEvent(PdmPlugin &plugin,
+        const std::string &payload) {
+    plugin.handlePdmEvent(payload.data(), payload.size());
+}
+
+std::string PdmPluginBench::encodeBinary(int pdmEvent,
+        const std::vector<std::pair<int, std::string>> &fields) {
+    std::string body;
+    for (const auto &field : fields) {
+        PdmEventBinaryField header = { (uint16_t) field.first,
+                (uint16_t) field.second.size() };
+        body.append((const char*) &header, sizeof(header));
+        body.append(field.second);
+    }
+
+    PdmEventBinaryHeader header = { PDM_EVENT_BINARY_MAGIC,
+            PDM_EVENT_BINARY_VERSION, (uint16_t) pdmEvent,
+            (uint32_t) body.size() };
+    return std::string((const char*) &header, sizeof(header)) + body;
+}
+
+JValue PdmPluginBench::makeDeviceList(EventType type, int count,
+        int firstDeviceNum) {
+    static const char *const nonStorageTypes[] = { "HID", "SOUND", "CAM",
+            "XPAD", "MTP", "PTP", "CDC", "BLUETOOTH" };
+
+    JValue list = JArray { };
+    for (int i = 0; i < count; i++) {
+        const char *deviceType =
+                (type == ATTACHED_STORAGE_DEVICE_LIST) ?
+                        "USB_STORAGE" : nonStorageTypes[i % 8];
+        list.append(JObject { { "deviceNum", firstDeviceNum + i }, {
+                "deviceType", deviceType } });
+    }
+
+    JValue value = JObject { { "returnValue", true } };
+    if (type == ATTACHED_STORAGE_DEVICE_LIST)
+        value.put(DeviceListTraits<ATTACHED_STORAGE_DEVICE_LIST>::key(), list);
+    else
+        value.put(DeviceListTraits<ATTACHED_NONSTORAGE_DEVICE_LIST>::key(),
+                list);
+    return value;
+}
+
+void PdmPluginBench::benchPdmEvents() {
+    MockManager manager;
+    auto plugin = startPlugin(manager);
+
+    for (size_t pdmEvent = 0; pdmEvent < benchEvents().size(); pdmEvent++) {
+        const BenchEvent &event = benchEvents()[pdmEvent];
+        std::string json(event.json);
+        run(std::string("pdmEvent/json/") + event.name, mIterations,
+                [&](uint64_t) {
+                    handlePdmEvent(*plugin, json);
+                });
+
+        std::string binary = encodeBinary(pdmEvent, event.fields);
+        run(std::string("pdmEvent/binary/") + event.name, mIterations,
+                [&](uint64_t) {
+                    handlePdmEvent(*plugin, binary);
+                });
+    }
+}
+
+void PdmPluginBench::benchDecoders() {
+    PdmEventParser parser;
+    PdmEventRecord record;
+    std::vector<std::string> values;
+
+    for (size_t pdmEvent = 0; pdmEvent < benchEvents().size(); pdmEvent++) {
+        const BenchEvent &event = benchEvents()[pdmEvent];
+        std::string json(event.json);
+        run(std::string("decode/dom/") + event.name, mIterations,
+                [&](uint64_t) {
+                    decodeDom(json, event, values);
+                });
+
+        run(std::string("decode/json/") + event.name, mIterations,
+                [&](uint64_t) {
+                    parser.decode(json.data(), json.size(), record);
+                });
+
+        std::string binary = encodeBinary(pdmEvent, event.fields);
+        run(std::string("decode/binary/") + event.name, mIterations,
+                [&](uint64_t) {
+                    PdmEventCodec::decodeBinary(binary.data(), binary.size(),
+                            record);
+                });
+    }
+}
+
+void PdmPluginBench::benchDeviceLists(EventType type) {
+    for (int count : DEVICE_COUNTS) {
+        MockManager manager;
+        auto plugin = startPlugin(manager);
+
+        //Every update plugs or unplugs the last device
+        JValue full = makeDeviceList(type, count);
+        JValue partial = makeDeviceList(type, count - 1);
+        JValue previousValue = makeDeviceList(type, 0);
+        manager.publish(subscriptionId(type), previousValue, partial);
+
+        run(std::string("deviceList/") + listName(type) + "/"
+                + std::to_string(count), mIterations, [&](uint64_t i) {
+            if (i & 1)
+                manager.publish(subscriptionId(type), full, partial);
+            else
+                manager.publish(subscriptionId(type), partial, full);
+        });
+
+        //PDM resending the list it sent last
+        run(std::string("deviceList/") + listName(type) + "/"
+                + std::to_string(count) + "/unchanged", mIterations,
+                [&](uint64_t) {
+                    manager.publish(subscriptionId(type), full, full);
+                });
+    }
+}
+
+void PdmPluginBench::benchListWorker(EventType type) {
+    for (int count : DEVICE_COUNTS) {
+        for (bool worker : { false, true }) {
+            MockManager manager;
+            auto plugin = startPlugin(manager);
+            if (worker && !plugin->startListWorker())
+                return;
+
+            JValue full = makeDeviceList(type, count);
+            JValue partial = makeDeviceList(type, count - 1);
+            JValue previousValue = makeDeviceList(type, 0);
+            manager.publish(subscriptionId(type), previousValue, partial);
+
+            //Same updates as deviceList/, the worker is waited for outside
+            //the main loop share
+            run(std::string("mainLoop/") + (worker ? "worker/" : "inline/")
+                    + listName(type) + "/" + std::to_string(count),
+                    mIterations, [&](uint64_t i) {
+                        onMainLoop([&] {
+                            if (i & 1)
+                                manager.publish(subscriptionId(type), full,
+                                        partial);
+                            else
+                                manager.publish(subscriptionId(type), partial,
+                                        full);
+                        });
+                        if (!worker)
+                            return;
+                        plugin->mListWorker->waitIdle();
+                        onMainLoop([&] {
+                            plugin->drainListWorker();
+                        });
+                    });
+        }
+    }
+}
+
+void PdmPluginBench::benchStorms() {
+    for (EventType type : { ATTACHED_STORAGE_DEVICE_LIST,
+            ATTACHED_NONSTORAGE_DEVICE_LIST }) {
+        for (int count : DEVICE_COUNTS) {
+            MockManager manager;
+            auto plugin = startPlugin(manager);
+
+            //All devices come and go at once, flushing coalesced toasts
+            JValue full = makeDeviceList(type, count);
+            JValue empty = makeDeviceList(type, 0);
+
+            run(std::string("storm/") + listName(type) + "/"
+                    + std::to_string(count), mIterations, [&](uint64_t i) {
+                if (i & 1)
+                    manager.publish(subscriptionId(type), full, empty);
+                else
+                    manager.publish(subscriptionId(type), empty, full);
+                manager.advance(PDM_TOAST_COALESCE_WINDOW_MS);
+            });
+        }
+    }
+}
+
+void PdmPluginBench::benchDiff() {
+    for (int count : DEVICE_COUNTS) {
+        DeviceListDiff devices;
+        std::vector<Device> full;
+        for (int i = 0; i < count; i++)
+            full.push_back( { i + 1, DEVICE_TYPE_USB_STORAGE, DEVICE_CONNECTED });
+        std::vector<Device> partial(full.begin(), full.end() - 1);
+
+        run("diff/" + std::to_string(count), mIterations, [&](uint64_t i) {
+            devices.snapshot() = (i & 1) ? partial : full;
+            devices.diff();
+        });
+    }
+}
+
+void PdmPluginBench::benchFormat() {
+    run("format/compile", mIterations, [&](uint64_t) {
+        MessageTemplate formatStarted(STORAGE_DEV_FORMAT_STARTED, { "DRIVE" });
+    });
+
+    MessageTemplate formatStarted(STORAGE_DEV_FORMAT_STARTED, { "DRIVE" });
+    std::string drive = "USB Drive sda1";
+    run("format/render", mIterations, [&](uint64_t) {
+        std::string message = formatStarted.render(drive);
+    });
+}
+
+bool PdmPluginBench::selected(const std::string &name) const {
+    return mFilter.empty() || name.find(mFilter) != std::string::npos;
+}
+
+void PdmPluginBench::run(const std::string &name, uint64_t iterations,
+        const std::function<void(uint64_t)> &op) {
+    if (!selected(name) || !iterations)
+        return;
+
+    //Warm up caches and let buffers grow to their steady size
+    for (uint64_t i = 0; i < iterations / 10 + 2; i++)
+        op(i);
+    mMainLoopNs = 0;
+
+    uint64_t allocations = AllocationCounter::allocations();
+    uint64_t bytes = AllocationCounter::bytes();
+    uint64_t startNs = getMonotonicTimeNs();
+    for (uint64_t i = 0; i < iterations; i++)
+        op(i);
+    uint64_t elapsedNs = getMonotonicTimeNs() - startNs;
+
+    mResults.push_back(
+            { name, iterations, (double) elapsedNs / iterations,
+                    (double) (AllocationCounter::allocations() - allocations)
+                            / iterations, (double) (AllocationCounter::bytes()
+                            - bytes) / iterations, mMainLoopNs ?
+                            (double) mMainLoopNs / iterations : -1.0 });
+    mMainLoopNs = 0;
+}
+
+void PdmPluginBench::onMainLoop(const std::function<void()> &op) {
+    uint64_t startNs = getMonotonicTimeNs();
+    op();
+    mMainLoopNs += getMonotonicTimeNs() - startNs;
+}
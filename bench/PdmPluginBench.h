@@ -0,0 +1,84 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "MockManager.h"
+#include "PdmPlugin.h"
+
+#include <pbnjson.hpp>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+/*
+ * Runs PdmPlugin against a MockManager and measures time and heap
+ * allocations per operation. Results are collected as JSON so they can be
+ * compared between builds.
+ */
+class PdmPluginBench {
+public:
+    PdmPluginBench(uint64_t iterations, const std::string &filter);
+
+    void runAll();
+    pbnjson::JValue results() const;
+
+    // Fresh plugin on a fresh manager, past the boot toast block and with
+    // empty device lists
+    static std::unique_ptr<PdmPlugin> startPlugin(MockManager &manager);
+    static void handlePdmEvent(PdmPlugin &plugin, const std::string &payload);
+    // Binary pdmEvent record, fields as (PdmEventField, value) pairs
+    static std::string encodeBinary(int pdmEvent,
+            const std::vector<std::pair<int, std::string>> &fields);
+    static pbnjson::JValue makeDeviceList(PdmUtils::EventType type,
+            int count, int firstDeviceNum = 1);
+
+private:
+    struct Result {
+        std::string name;
+        uint64_t iterations;
+        double nsPerOp;
+        double allocationsPerOp;
+        double bytesPerOp;
+        // Share of nsPerOp spent on the plugin main loop, negative when
+        // the benchmark does not measure it
+        double mainLoopNsPerOp;
+    };
+
+    void benchPdmEvents();
+    void benchDecoders();
+    void benchDeviceLists(PdmUtils::EventType type);
+    void benchListWorker(PdmUtils::EventType type);
+    void benchStorms();
+    void benchDiff();
+    void benchFormat();
+
+    bool selected(const std::string &name) const;
+    void run(const std::string &name, uint64_t iterations,
+            const std::function<void(uint64_t)> &op);
+    // Runs op, counting its time toward the main loop share of the
+    // benchmark running
+    void onMainLoop(const std::function<void()> &op);
+
+    uint64_t mIterations;
+    std::string mFilter;
+    std::vector<Result> mResults;
+    uint64_t mMainLoopNs;
+};
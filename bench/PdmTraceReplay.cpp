@@ -0,0 +1,179 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PdmTraceReplay.h"
+
+#include <memory>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+using namespace pbnjson;
+using namespace PdmUtils;
+
+//Lets timeouts armed by the last records (toast coalescing) fire
+static const uint64_t DRAIN_TIME_MS = 60000;
+
+//Clock steps while running out the boot block before a runtime trace
+static const uint64_t BOOT_STEP_MS = 100;
+
+static const char* callTypeName(MockManager::CallType type) {
+    switch (type) {
+    case MockManager::CALL_TOAST:
+        return "toast";
+    case MockManager::CALL_ALERT:
+        return "alert";
+    case MockManager::CALL_CLOSE_ALERT:
+        return "closeAlert";
+    }
+    return "unknown";
+}
+
+PdmTraceReplay::PdmTraceReplay(MockManager &manager) :
+        mManager(manager), mStartupTrace(false), mWallNs(0), mProcessingNs(0), mMaxProcessingNs(0) {
+}
+
+bool PdmTraceReplay::load(const std::string &path) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) {
+        fprintf(stderr, "Cannot open %s\n", path.c_str());
+        return false;
+    }
+
+    PdmTraceFileHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1
+            || header.magic != PDM_TRACE_MAGIC
+            || header.version != PDM_TRACE_VERSION) {
+        fprintf(stderr, "%s is not a pdm trace\n", path.c_str());
+        fclose(file);
+        return false;
+    }
+
+    mStartupTrace = header.flags & PDM_TRACE_FLAG_STARTUP;
+    mRecords.clear();
+    PdmTraceRecordHeader recordHeader;
+    while (fread(&recordHeader, sizeof(recordHeader), 1, file) == 1) {
+        Record record;
+        record.offsetNs =
+                (recordHeader.timestampNs > header.startNs) ?
+                        recordHeader.timestampNs - header.startNs : 0;
+        record.type = (PdmTraceRecordType) recordHeader.type;
+        record.payload.resize(recordHeader.length);
+        if (recordHeader.length
+                && fread(&record.payload[0], recordHeader.length, 1, file)
+                        != 1) {
+            //A trace cut short by a crash is still useful up to here
+            fprintf(stderr, "Truncated record after %zu records\n",
+                    mRecords.size());
+            break;
+        }
+        mRecords.push_back(std::move(record));
+    }
+
+    fclose(file);
+    return true;
+}
+
+void PdmTraceReplay::run(bool realTime) {
+    mManager.setRecording(true);
+    mManager.clearCalls();
+    mProcessingNs = 0;
+    mMaxProcessingNs = 0;
+
+    std::unique_ptr<PdmPlugin> plugin(new PdmPlugin(&mManager, [this] {
+        return mManager.nowMs();
+    }));
+    //Keep a startup trace of the replay itself from clobbering any file
+    plugin->mTrace.attach(open("/dev/null", O_WRONLY | O_CLOEXEC));
+    plugin->startMonitoring();
+    plugin->mTrace.stop();
+
+    //A trace started at runtime was recorded long after the boot block, it
+    //must not swallow the first records
+    if (!mStartupTrace) {
+        while (plugin->toastsBlocked && mManager.nowMs() < DRAIN_TIME_MS)
+            mManager.advance(BOOT_STEP_MS);
+    }
+    uint64_t baseMs = mManager.nowMs();
+
+    uint64_t startNs = getMonotonicTimeNs();
+    for (const auto &record : mRecords) {
+        uint64_t recordMs = baseMs + record.offsetNs / 1000000;
+        if (recordMs > mManager.nowMs()) {
+            uint64_t waitMs = recordMs - mManager.nowMs();
+            if (realTime)
+                usleep(waitMs * 1000);
+            mManager.advance(waitMs);
+        }
+
+        uint64_t deliverNs = getMonotonicTimeNs();
+        deliver(*plugin, record);
+        uint64_t elapsedNs = getMonotonicTimeNs() - deliverNs;
+        mProcessingNs += elapsedNs;
+        if (elapsedNs > mMaxProcessingNs)
+            mMaxProcessingNs = elapsedNs;
+    }
+    mManager.advance(DRAIN_TIME_MS);
+    mWallNs = getMonotonicTimeNs() - startNs;
+}
+
+void PdmTraceReplay::deliver(PdmPlugin &plugin, const Record &record) {
+    switch (record.type) {
+    case PDM_TRACE_STORAGE_LIST:
+    case PDM_TRACE_NONSTORAGE_LIST: {
+        size_t split = record.payload.find('\0');
+        if (split == std::string::npos) {
+            fprintf(stderr, "Malformed device list record\n");
+            return;
+        }
+        JValue previousValue = JDomParser::fromString(
+                record.payload.substr(0, split));
+        JValue value = JDomParser::fromString(record.payload.substr(split + 1));
+        mManager.publish(
+                (record.type == PDM_TRACE_STORAGE_LIST) ?
+                        "attachedStorageDeviceList" :
+                        "attachedNonStorageDeviceList", previousValue, value);
+        break;
+    }
+    case PDM_TRACE_PDM_EVENT: {
+        plugin.handlePdmEvent(record.payload.data(), record.payload.size());
+        break;
+    }
+    default: {
+        //Newer record types, nothing to replay them with
+        break;
+    }
+    }
+}
+
+JValue PdmTraceReplay::report() const {
+    JValue calls = JArray { };
+    for (const auto &call : mManager.calls()) {
+        JValue entry = JObject { { "timeMs", (int64_t) call.timeMs }, { "type",
+                callTypeName(call.type) } };
+        if (!call.id.empty())
+            entry.put("id", call.id);
+        if (!call.message.empty())
+            entry.put("message", call.message);
+        calls.append(entry);
+    }
+
+    return JObject { { "records", (int64_t) mRecords.size() }, { "wallNs",
+            (int64_t) mWallNs }, { "processingNs", (int64_t) mProcessingNs }, {
+            "maxProcessingNs", (int64_t) mMaxProcessingNs }, { "calls", calls } };
+}
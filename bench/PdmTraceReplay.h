@@ -0,0 +1,63 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "MockManager.h"
+#include "PdmPlugin.h"
+#include "PdmTrace.h"
+
+#include <pbnjson.hpp>
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+/*
+ * Feeds a recorded trace through a fresh PdmPlugin on a MockManager. The
+ * virtual clock follows the trace timestamps, so toast timeouts behave as
+ * they did on the device. Only a trace recorded from startup replays the
+ * boot block, for one started at runtime the block is run out first.
+ * Records are delivered either as fast as possible or at the recorded
+ * pace.
+ */
+class PdmTraceReplay {
+public:
+    explicit PdmTraceReplay(MockManager &manager);
+
+    bool load(const std::string &path);
+    void run(bool realTime);
+
+    // Toasts and alerts in order, plus processing times
+    pbnjson::JValue report() const;
+
+private:
+    struct Record {
+        uint64_t offsetNs;
+        PdmTraceRecordType type;
+        std::string payload;
+    };
+
+    void deliver(PdmPlugin &plugin, const Record &record);
+
+    MockManager &mManager;
+    std::vector<Record> mRecords;
+    bool mStartupTrace;
+    uint64_t mWallNs;
+    uint64_t mProcessingNs;
+    uint64_t mMaxProcessingNs;
+};
@@ -0,0 +1,62 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PdmPluginBench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const uint64_t DEFAULT_ITERATIONS = 10000;
+
+static void usage(const char *name) {
+    fprintf(stderr, "Usage: %s [--iterations N] [--filter TEXT] [--output FILE]\n"
+            "Prints benchmark results as JSON, one entry per benchmark.\n",
+            name);
+}
+
+int main(int argc, char *argv[]) {
+    uint64_t iterations = DEFAULT_ITERATIONS;
+    std::string filter;
+    const char *output = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--iterations") && i + 1 < argc) {
+            iterations = strtoull(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--filter") && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (!strcmp(argv[i], "--output") && i + 1 < argc) {
+            output = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    PdmPluginBench bench(iterations, filter);
+    bench.runAll();
+
+    std::string results = bench.results().stringify("  ");
+    FILE *file = output ? fopen(output, "w") : stdout;
+    if (!file) {
+        fprintf(stderr, "Cannot open %s\n", output);
+        return 1;
+    }
+    fprintf(file, "%s\n", results.c_str());
+    if (output)
+        fclose(file);
+    return 0;
+}
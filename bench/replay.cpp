@@ -0,0 +1,55 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PdmTraceReplay.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static void usage(const char *name) {
+    fprintf(stderr, "Usage: %s [--real-time] TRACE\n"
+            "Replays a pdm trace and prints the resulting toasts and alerts "
+            "as JSON.\n", name);
+}
+
+int main(int argc, char *argv[]) {
+    bool realTime = false;
+    const char *path = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--real-time")) {
+            realTime = true;
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!path) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    MockManager manager;
+    PdmTraceReplay replay(manager);
+    if (!replay.load(path))
+        return 1;
+
+    replay.run(realTime);
+    printf("%s\n", replay.report().stringify("  ").c_str());
+    return 0;
+}
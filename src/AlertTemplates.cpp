@@ -0,0 +1,107 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "AlertTemplates.h"
+
+#include "Logging.h"
+#include "PdmUtils.h"
+
+using namespace pbnjson;
+using namespace PdmUtils;
+
+static const char *const FSCK_METHOD =
+        "luna://com.webos.service.pdm/mountandFullFsck";
+
+//Button index in the fsck button array
+enum FsckButton {
+    FSCK_BUTTON_CHECK_AND_REPAIR = 0, FSCK_BUTTON_OPEN_NOW
+};
+
+AlertTemplates::AlertTemplates(Localizer localizer,
+        const std::string &alertClosedUri) :
+        mLocalizer(std::move(localizer)), mValid(false), mCloseAction(
+                JObject { { "uri", alertClosedUri }, { "params", JObject { {
+                        "alertId", "" } } } }) {
+}
+
+const std::string& AlertTemplates::message(AlertMessage alertMessage) {
+    if (!mValid)
+        build();
+    return mMessages[alertMessage];
+}
+
+const JValue& AlertTemplates::okButtons() {
+    if (!mValid)
+        build();
+    return mOkButtons;
+}
+
+std::string AlertTemplates::fsckMessage(const std::string &deviceName) {
+    if (!mValid)
+        build();
+    return mFsckMessage.render(deviceName);
+}
+
+JValue AlertTemplates::fsckButtons(const std::string &mountName) {
+    if (!mValid)
+        build();
+
+    //Only the mount name differs between alerts
+    JValue buttons = mFsckButtons.duplicate();
+    buttons[FSCK_BUTTON_CHECK_AND_REPAIR]["params"].put("mountName", mountName);
+    buttons[FSCK_BUTTON_OPEN_NOW]["params"].put("mountName", mountName);
+    return buttons;
+}
+
+JValue AlertTemplates::closeAction(const std::string &alertId) const {
+    JValue action = mCloseAction.duplicate();
+    action["params"].put("alertId", alertId);
+    return action;
+}
+
+void AlertTemplates::prepare() {
+    if (!mValid)
+        build();
+}
+
+void AlertTemplates::invalidate() {
+    mValid = false;
+}
+
+void AlertTemplates::build() {
+    LOG_DEBUG("%s", __FUNCTION__);
+
+    mMessages[ALERT_MESSAGE_MAX_USB_STORAGE_DEVICES] = mLocalizer(
+            MAX_USB_DEVICE_LIMIT_REACHED);
+    mMessages[ALERT_MESSAGE_REMOVE_BEFORE_MOUNT] = mLocalizer(
+            REMOVE_USB_DEVICE_BEFORE_MOUNT);
+    mMessages[ALERT_MESSAGE_UNSUPPORTED_FS] = mLocalizer(
+            USB_STORAGE_DEV_UNSUPPORTED_FS);
+    mFsckMessage = MessageTemplate(mLocalizer(USB_STORAGE_FSCK_TIME_OUT), {
+            "DEVICE" });
+
+    mOkButtons = JArray { JObject { { "label", mLocalizer("OK") }, {
+            "position", "middle" }, { "params",
+            JObject { { "action", "close" } } } } };
+
+    mFsckButtons = JArray { JObject { { "label", mLocalizer("CHECK & REPAIR") },
+            { "onclick", FSCK_METHOD }, { "params", JObject { { "needFsck",
+                    true }, { "mountName", "" } } } }, JObject { { "label",
+            mLocalizer("OPEN NOW") }, { "onclick", FSCK_METHOD }, { "params",
+            JObject { { "needFsck", false }, { "mountName", "" } } } } };
+
+    mValid = true;
+}
@@ -0,0 +1,73 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "MessageTemplate.h"
+
+#include <pbnjson.hpp>
+
+#include <functional>
+#include <string>
+
+enum AlertMessage {
+    ALERT_MESSAGE_MAX_USB_STORAGE_DEVICES = 0,
+    ALERT_MESSAGE_REMOVE_BEFORE_MOUNT,
+    ALERT_MESSAGE_UNSUPPORTED_FS,
+    ALERT_MESSAGE_COUNT
+};
+
+/*
+ * Localized alert texts and button arrays, built once per UI locale. The
+ * returned JValues are shared and must not be modified, fsckButtons() and
+ * closeAction() hand out a patched copy instead.
+ */
+class AlertTemplates {
+public:
+    typedef std::function<std::string(const std::string &text)> Localizer;
+
+    // alertClosedUri is called with the alert id when an alert goes away
+    AlertTemplates(Localizer localizer, const std::string &alertClosedUri);
+
+    const std::string& message(AlertMessage alertMessage);
+
+    // Fsck time out question naming deviceName
+    std::string fsckMessage(const std::string &deviceName);
+
+    // Single "OK" button closing the alert
+    const pbnjson::JValue& okButtons();
+
+    // "Check & Repair" and "Open Now" buttons for mountName
+    pbnjson::JValue fsckButtons(const std::string &mountName);
+
+    // onClose action reporting alertId back to the plugin
+    pbnjson::JValue closeAction(const std::string &alertId) const;
+
+    // Builds the texts and buttons now rather than on first use
+    void prepare();
+    void invalidate();
+
+private:
+    void build();
+
+    Localizer mLocalizer;
+    bool mValid;
+    std::string mMessages[ALERT_MESSAGE_COUNT];
+    MessageTemplate mFsckMessage;
+    pbnjson::JValue mOkButtons;
+    pbnjson::JValue mFsckButtons;
+    pbnjson::JValue mCloseAction;
+};
@@ -0,0 +1,125 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "DeviceDebouncer.h"
+
+#include "Logging.h"
+
+using namespace PdmUtils;
+
+static const char *const DEBOUNCE_TIMEOUT_ID = "deviceDebounce";
+
+//Resolution of the hold time, a hold lasts this many ticks
+static const unsigned int TICKS_PER_HOLD = 8;
+//Power of two larger than TICKS_PER_HOLD + 1, so a slot only ever holds
+//entries due on the same tick
+static const unsigned int WHEEL_SIZE = 16;
+
+DeviceDebouncer::DeviceDebouncer(EventMonitor::Manager *manager,
+        unsigned int holdMs, Handler handler) :
+        mManager(manager), mHoldMs(holdMs), mTickMs(
+                (holdMs + TICKS_PER_HOLD - 1) / TICKS_PER_HOLD), mHandler(
+                std::move(handler)), mWheel(WHEEL_SIZE, nullptr), mTick(0), mTimerRunning(
+                false), mCancelled(0) {
+}
+
+uint64_t DeviceDebouncer::key(const Device &device) {
+    return ((uint64_t) (uint32_t) device.deviceNumber << 8) | device.deviceType;
+}
+
+void DeviceDebouncer::post(const Device &device) {
+    if (!mHoldMs) {
+        mHandler(device);
+        return;
+    }
+
+    auto iter = mEntries.find(key(device));
+    if (iter == mEntries.end()) {
+        Entry &entry = mEntries[key(device)];
+        entry.device = device;
+        entry.reportedStatus =
+                (device.deviceStatus == DEVICE_CONNECTED) ?
+                        DEVICE_DISCONNECTED : DEVICE_CONNECTED;
+        schedule(entry);
+        return;
+    }
+
+    Entry &entry = iter->second;
+    unlink(entry);
+    if (device.deviceStatus == entry.reportedStatus) {
+        LOG_DEBUG("%s deviceNum %d flapped back, nothing to report",
+                __FUNCTION__, device.deviceNumber);
+        mCancelled++;
+        mEntries.erase(iter);
+        return;
+    }
+
+    //Changed again, wait for it to settle from now on
+    entry.device = device;
+    schedule(entry);
+}
+
+void DeviceDebouncer::schedule(Entry &entry) {
+    //One extra tick covers the part of the current tick already gone
+    entry.dueTick = mTick + TICKS_PER_HOLD + 1;
+    Entry *&head = mWheel[entry.dueTick & (WHEEL_SIZE - 1)];
+    entry.prev = nullptr;
+    entry.next = head;
+    if (head)
+        head->prev = &entry;
+    head = &entry;
+
+    if (!mTimerRunning) {
+        mTimerRunning = true;
+        mManager->setTimeout(DEBOUNCE_TIMEOUT_ID, mTickMs, true,
+                [this](const std::string &timeoutId) {
+                    this->tick();
+                });
+    }
+}
+
+void DeviceDebouncer::unlink(Entry &entry) {
+    if (entry.prev)
+        entry.prev->next = entry.next;
+    else
+        mWheel[entry.dueTick & (WHEEL_SIZE - 1)] = entry.next;
+    if (entry.next)
+        entry.next->prev = entry.prev;
+}
+
+void DeviceDebouncer::tick() {
+    mTick++;
+    Entry *&slot = mWheel[mTick & (WHEEL_SIZE - 1)];
+    Entry *due = slot;
+    slot = nullptr;
+
+    //Collect first, the handler must not see a half updated wheel
+    mSettled.clear();
+    while (due) {
+        Entry *next = due->next;
+        mSettled.push_back(due->device);
+        mEntries.erase(key(due->device));
+        due = next;
+    }
+
+    if (mEntries.empty()) {
+        mTimerRunning = false;
+        mManager->cancelTimeout(DEBOUNCE_TIMEOUT_ID);
+    }
+
+    for (const auto &device : mSettled)
+        mHandler(device);
+}
@@ -0,0 +1,79 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "PdmUtils.h"
+
+#include <event-monitor-api/pluginbase.hpp>
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include <stdint.h>
+
+/*
+ * Holds device transitions back for holdMs. A device that flips back to
+ * the state it was in before the hold time is up is not reported at all,
+ * otherwise its last state is reported once the hold time has passed
+ * without further changes.
+ *
+ * Pending devices sit in a timer wheel driven by one repeating manager
+ * timeout, so adding, rescheduling and cancelling are O(1) each. The
+ * timeout only runs while something is pending. A hold time of 0 reports
+ * every transition right away.
+ */
+class DeviceDebouncer {
+public:
+    typedef std::function<void(const PdmUtils::Device &device)> Handler;
+
+    DeviceDebouncer(EventMonitor::Manager *manager, unsigned int holdMs,
+            Handler handler);
+
+    void post(const PdmUtils::Device &device);
+
+    // Devices whose flapping cancelled out
+    uint64_t cancelled() const {
+        return mCancelled;
+    }
+
+private:
+    struct Entry {
+        PdmUtils::Device device;
+        PdmUtils::DeviceStatus reportedStatus;
+        uint64_t dueTick;
+        Entry *prev;
+        Entry *next;
+    };
+
+    static uint64_t key(const PdmUtils::Device &device);
+
+    void schedule(Entry &entry);
+    void unlink(Entry &entry);
+    void tick();
+
+    EventMonitor::Manager *mManager;
+    unsigned int mHoldMs;
+    unsigned int mTickMs;
+    Handler mHandler;
+    std::unordered_map<uint64_t, Entry> mEntries;
+    std::vector<Entry*> mWheel;
+    std::vector<PdmUtils::Device> mSettled;
+    uint64_t mTick;
+    bool mTimerRunning;
+    uint64_t mCancelled;
+};
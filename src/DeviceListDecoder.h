@@ -0,0 +1,117 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "DeviceListDiff.h"
+#include "PdmUtils.h"
+
+#include <pbnjson.hpp>
+
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+template<PdmUtils::EventType type>
+struct DeviceListTraits;
+
+template<>
+struct DeviceListTraits<PdmUtils::ATTACHED_STORAGE_DEVICE_LIST> {
+    static const std::string& key() {
+        static const std::string listKey("storageDeviceList");
+        return listKey;
+    }
+};
+
+template<>
+struct DeviceListTraits<PdmUtils::ATTACHED_NONSTORAGE_DEVICE_LIST> {
+    static const std::string& key() {
+        static const std::string listKey("nonStorageDeviceList");
+        return listKey;
+    }
+};
+
+//FNV-1a over 32 bit words
+static const uint64_t DEVICE_LIST_HASH_BASIS = 0xcbf29ce484222325ull;
+static const uint64_t DEVICE_LIST_HASH_PRIME = 0x100000001b3ull;
+
+inline uint64_t hashDeviceListEntry(uint64_t hash,
+        const PdmUtils::Device &device) {
+    hash = (hash ^ (uint32_t) device.deviceNumber) * DEVICE_LIST_HASH_PRIME;
+    return (hash ^ (uint32_t) device.deviceType) * DEVICE_LIST_HASH_PRIME;
+}
+
+/*
+ * Decodes the device array of a getAttached*DeviceList response into
+ * devices in one pass. Entries without deviceNum or deviceType are skipped.
+ * Returns false if the response carries no list at all. If hash is given it
+ * receives a hash of the decoded deviceNum and deviceType pairs, in order.
+ */
+template<PdmUtils::EventType type>
+bool decodeDeviceList(const pbnjson::JValue &value,
+        std::vector<PdmUtils::Device> &devices, uint64_t *hash = nullptr) {
+    static const std::string deviceNumKey("deviceNum");
+    static const std::string deviceTypeKey("deviceType");
+
+    devices.clear();
+    uint64_t listHash = DEVICE_LIST_HASH_BASIS;
+
+    pbnjson::JValue list = value[DeviceListTraits<type>::key()];
+    if (!list.isArray())
+        return false;
+
+    int length = list.arraySize();
+    devices.reserve(length);
+    //PDM type names fit the small string buffer, this does not allocate
+    std::string typeName;
+
+    for (int i = 0; i < length; i++) {
+        pbnjson::JValue item = list[i];
+        pbnjson::JValue deviceNum = item[deviceNumKey];
+        if (!deviceNum.isNumber())
+            continue;
+
+        pbnjson::JValue deviceType = item[deviceTypeKey];
+        if (!deviceType.isString())
+            continue;
+
+        deviceType.asString(typeName);
+        PdmUtils::Device device;
+        device.deviceNumber = deviceNum.asNumber<int>();
+        device.deviceType = PdmUtils::internDeviceType(typeName);
+        device.deviceStatus = PdmUtils::DEVICE_CONNECTED;
+        devices.push_back(device);
+        listHash = hashDeviceListEntry(listHash, device);
+    }
+    if (hash)
+        *hash = listHash;
+    return true;
+}
+
+/*
+ * Decodes into the snapshot of devices and hands it the hash, so diff()
+ * can skip a list that is the same as the one it committed last.
+ */
+template<PdmUtils::EventType type>
+bool decodeDeviceList(const pbnjson::JValue &value, DeviceListDiff &devices) {
+    uint64_t hash;
+    if (!decodeDeviceList<type>(value, devices.snapshot(), &hash))
+        return false;
+
+    devices.setSnapshotHash(hash);
+    return true;
+}
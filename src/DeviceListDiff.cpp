@@ -0,0 +1,168 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "DeviceListDiff.h"
+
+#include "Logging.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace PdmUtils;
+
+//Enough for a fully populated hub without growing
+static const size_t INITIAL_CAPACITY = 16;
+
+DeviceListDiff::DeviceListDiff() :
+        mSnapshotHash(0), mCommittedHash(0), mSnapshotHashed(false), mCommittedHashValid(
+                false), mHashHits(0), mHashMisses(0) {
+    mSnapshot.reserve(INITIAL_CAPACITY);
+    mDevices.reserve(INITIAL_CAPACITY);
+    mScratch.reserve(INITIAL_CAPACITY);
+    mConnected.reserve(INITIAL_CAPACITY);
+    mDisconnected.reserve(INITIAL_CAPACITY);
+}
+
+static bool byDeviceNumber(const Device &first, const Device &second) {
+    return first.deviceNumber < second.deviceNumber;
+}
+
+void DeviceListDiff::normalize() {
+    auto &snapshot = mSnapshot;
+    //PDM sends its lists ordered, so this is normally one check. Otherwise
+    //a bottom-up merge sort between the snapshot and the scratch buffer,
+    //O(n log n) and stable without allocating. Stability matters, the
+    //dominant type of a device with several interfaces depends on the
+    //order they were reported in.
+    if (!std::is_sorted(snapshot.begin(), snapshot.end(), byDeviceNumber)) {
+        size_t size = snapshot.size();
+        mScratch.resize(size);
+        std::vector<Device> *from = &snapshot;
+        std::vector<Device> *to = &mScratch;
+        for (size_t width = 1; width < size; width *= 2) {
+            for (size_t low = 0; low < size; low += 2 * width) {
+                size_t middle = std::min(low + width, size);
+                size_t high = std::min(low + 2 * width, size);
+                std::merge(from->begin() + low, from->begin() + middle,
+                        from->begin() + middle, from->begin() + high,
+                        to->begin() + low, byDeviceNumber);
+            }
+            std::swap(from, to);
+        }
+        if (from != &snapshot)
+            snapshot.swap(mScratch);
+    }
+
+    //Collapse interfaces of the same device into one entry
+    size_t last = 0;
+    for (size_t i = 1; i < snapshot.size(); i++) {
+        if (snapshot[i].deviceNumber == snapshot[last].deviceNumber) {
+            snapshot[last].deviceType = getDominantDeviceType(
+                    snapshot[last].deviceType, snapshot[i].deviceType);
+        } else if (++last != i) {
+            std::swap(snapshot[last], snapshot[i]);
+        }
+    }
+    if (!snapshot.empty())
+        snapshot.resize(last + 1);
+}
+
+void DeviceListDiff::commitHash(bool valid) {
+    mCommittedHash = mSnapshotHash;
+    mCommittedHashValid = valid && mSnapshotHashed;
+    mSnapshotHashed = false;
+}
+
+void DeviceListDiff::diff() {
+    mConnected.clear();
+    mDisconnected.clear();
+    if (mSnapshotHashed) {
+        if (mCommittedHashValid && mSnapshotHash == mCommittedHash) {
+            //Same entries in the same order, nothing can have changed
+            mHashHits.fetch_add(1, std::memory_order_relaxed);
+            mSnapshotHashed = false;
+            return;
+        }
+        mHashMisses.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    normalize();
+    auto &snapshot = mSnapshot;
+    mScratch.clear();
+
+    auto current = mDevices.begin();
+    auto received = snapshot.begin();
+    while (current != mDevices.end() || received != snapshot.end()) {
+        if (received == snapshot.end()
+                || (current != mDevices.end()
+                        && current->deviceNumber < received->deviceNumber)) {
+            LOG_DEBUG("%s deviceNum %d device has been disconnected",
+                    __FUNCTION__, current->deviceNumber);
+            mDisconnected.push_back(*current);
+            mDisconnected.back().deviceStatus = DEVICE_DISCONNECTED;
+            ++current;
+        } else if (current == mDevices.end()
+                || received->deviceNumber < current->deviceNumber) {
+            LOG_DEBUG("%s deviceNum %d deviceType %d new entry", __FUNCTION__,
+                    received->deviceNumber, received->deviceType);
+            received->deviceStatus = DEVICE_CONNECTED;
+            mConnected.push_back(*received);
+            mScratch.push_back(*received);
+            ++received;
+        } else {
+            mScratch.push_back(*current);
+            ++current;
+            ++received;
+        }
+    }
+
+    mDevices.swap(mScratch);
+    commitHash(true);
+}
+
+void DeviceListDiff::merge() {
+    //Only a merge into an empty list leaves exactly the snapshot behind
+    commitHash(mDevices.empty());
+
+    normalize();
+    auto &snapshot = mSnapshot;
+    mScratch.clear();
+
+    auto current = mDevices.begin();
+    auto received = snapshot.begin();
+    while (current != mDevices.end() || received != snapshot.end()) {
+        if (received == snapshot.end()
+                || (current != mDevices.end()
+                        && current->deviceNumber < received->deviceNumber)) {
+            mScratch.push_back(*current);
+            ++current;
+        } else if (current == mDevices.end()
+                || received->deviceNumber < current->deviceNumber) {
+            mScratch.push_back(*received);
+            ++received;
+        } else {
+            mScratch.push_back(*current);
+            mScratch.back().deviceType = getDominantDeviceType(
+                    current->deviceType, received->deviceType);
+            LOG_DEBUG("%s proper deviceType: %d", __FUNCTION__,
+                    mScratch.back().deviceType);
+            ++current;
+            ++received;
+        }
+    }
+
+    mDevices.swap(mScratch);
+}
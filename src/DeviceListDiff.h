@@ -0,0 +1,96 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "PdmUtils.h"
+
+#include <atomic>
+#include <vector>
+
+#include <stdint.h>
+
+/*
+ * Attached device list kept as a flat vector sorted by deviceNumber.
+ * A new snapshot is merged against it in one linear pass and the deltas
+ * land in buffers that are reused between updates.
+ *
+ * PDM often resends an unchanged list. When the snapshot comes with a hash
+ * of its entries, diff() compares it with the hash of the snapshot it
+ * committed last and skips the merge on a match.
+ */
+class DeviceListDiff {
+public:
+    DeviceListDiff();
+
+    // Buffer the next snapshot is decoded into
+    std::vector<PdmUtils::Device>& snapshot() {
+        return mSnapshot;
+    }
+
+    // Hash of snapshot() in the order it was decoded, used by the next
+    // diff() or merge() only
+    void setSnapshotHash(uint64_t hash) {
+        mSnapshotHash = hash;
+        mSnapshotHashed = true;
+    }
+
+    // Replaces the list with snapshot() and fills connected() and
+    // disconnected(). Devices already known keep the type they were first
+    // reported with.
+    void diff();
+
+    // Adds snapshot() to the list without reporting anything, used for the
+    // devices that were attached before we started
+    void merge();
+
+    // Hashed snapshots diff() skipped as unchanged, and those it merged.
+    // Read from the main loop while the list worker may be diffing.
+    uint64_t hashHits() const {
+        return mHashHits.load(std::memory_order_relaxed);
+    }
+    uint64_t hashMisses() const {
+        return mHashMisses.load(std::memory_order_relaxed);
+    }
+
+    const std::vector<PdmUtils::Device>& devices() const {
+        return mDevices;
+    }
+    const std::vector<PdmUtils::Device>& connected() const {
+        return mConnected;
+    }
+    const std::vector<PdmUtils::Device>& disconnected() const {
+        return mDisconnected;
+    }
+
+private:
+    // Sorts snapshot() by deviceNumber and merges duplicate entries
+    void normalize();
+
+    void commitHash(bool valid);
+
+    std::vector<PdmUtils::Device> mSnapshot;
+    std::vector<PdmUtils::Device> mDevices;
+    std::vector<PdmUtils::Device> mScratch;
+    std::vector<PdmUtils::Device> mConnected;
+    std::vector<PdmUtils::Device> mDisconnected;
+    uint64_t mSnapshotHash;
+    uint64_t mCommittedHash;
+    bool mSnapshotHashed;
+    bool mCommittedHashValid;
+    std::atomic<uint64_t> mHashHits;
+    std::atomic<uint64_t> mHashMisses;
+};
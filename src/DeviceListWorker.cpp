@@ -0,0 +1,185 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "DeviceListWorker.h"
+
+#include "DeviceListDecoder.h"
+#include "Logging.h"
+#include "PluginMetrics.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <system_error>
+
+using namespace PdmUtils;
+
+DeviceListWorker::DeviceListWorker(DeviceListDiff &storageDevices,
+        DeviceListDiff &nonStorageDevices) :
+        mLists { &storageDevices, &nonStorageDevices }, mJobFd(-1), mPending(
+                0), mStop(false), mNotified(false), mNotifyFd(-1) {
+}
+
+DeviceListWorker::~DeviceListWorker() {
+    if (mThread.joinable()) {
+        mStop.store(true, std::memory_order_release);
+        uint64_t one = 1;
+        if (write(mJobFd, &one, sizeof(one)) < 0)
+            LOG_DEBUG("%s eventfd write failed", __FUNCTION__);
+        mThread.join();
+    }
+    if (mJobFd >= 0)
+        close(mJobFd);
+    if (mNotifyFd >= 0)
+        close(mNotifyFd);
+}
+
+bool DeviceListWorker::start() {
+    //The worker blocks in read(), the job fd must not be non-blocking
+    mJobFd = eventfd(0, EFD_CLOEXEC);
+    mNotifyFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (mJobFd < 0 || mNotifyFd < 0) {
+        LOG_ERROR(MSGID_PDM_PLUGIN_INFO, 0, "Failed to create eventfd");
+        return false;
+    }
+
+    //The thread inherits our signal mask. Block everything while creating
+    //it, so SIGUSR2 and friends are only ever handled on the main thread.
+    sigset_t allSignals, savedSignals;
+    sigfillset(&allSignals);
+    pthread_sigmask(SIG_SETMASK, &allSignals, &savedSignals);
+    try {
+        mThread = std::thread(&DeviceListWorker::run, this);
+    } catch (const std::system_error &error) {
+        pthread_sigmask(SIG_SETMASK, &savedSignals, nullptr);
+        LOG_ERROR(MSGID_PDM_PLUGIN_INFO, 0, "Failed to start worker: %s",
+                error.what());
+        return false;
+    }
+    pthread_sigmask(SIG_SETMASK, &savedSignals, nullptr);
+    return true;
+}
+
+bool DeviceListWorker::post(EventType type, JobType jobType,
+        const pbnjson::JValue &value, uint64_t startNs) {
+    //Counted first, so waitIdle() cannot miss a job the worker already took
+    mPending.fetch_add(1, std::memory_order_relaxed);
+    //The main loop keeps the value as the next previousValue, the worker
+    //never touches a DOM shared with it
+    if (!mJobs.push( { type, jobType, value.duplicate(), startNs })) {
+        mPending.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint64_t one = 1;
+    if (write(mJobFd, &one, sizeof(one)) < 0)
+        LOG_DEBUG("%s eventfd write failed", __FUNCTION__);
+    return true;
+}
+
+void DeviceListWorker::drain(const ResultHandler &handler) {
+    uint64_t count;
+    //Clear the flag before popping, a push racing with the last pop then
+    //signals the eventfd again. The exchange pairs with the one in push(),
+    //making the results pushed before it visible here.
+    if (read(mNotifyFd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+        LOG_DEBUG("%s eventfd read failed", __FUNCTION__);
+    mNotified.exchange(false, std::memory_order_acq_rel);
+
+    Result result;
+    while (mResults.pop(result))
+        handler(result);
+}
+
+void DeviceListWorker::waitIdle() {
+    while (mPending.load(std::memory_order_acquire))
+        std::this_thread::yield();
+}
+
+void DeviceListWorker::run() {
+    Job job;
+    for (;;) {
+        while (mJobs.pop(job)) {
+            process(job);
+            //Drop our reference before the main loop sees the update done
+            job.value = pbnjson::JValue();
+            mPending.fetch_sub(1, std::memory_order_release);
+        }
+        if (mStop.load(std::memory_order_acquire))
+            return;
+
+        //A job posted since the last pop has already bumped the counter,
+        //so this returns right away
+        uint64_t count;
+        if (read(mJobFd, &count, sizeof(count)) < 0 && errno != EINTR)
+            LOG_DEBUG("%s eventfd read failed", __FUNCTION__);
+    }
+}
+
+void DeviceListWorker::process(Job &job) {
+    LOG_DEBUG("%s type %d job %d", __FUNCTION__, job.type, job.jobType);
+
+    DeviceListDiff &devices = *mLists[job.type];
+    uint64_t decodeStartNs = getMonotonicTimeNs();
+    bool decoded =
+            (job.type == ATTACHED_STORAGE_DEVICE_LIST) ?
+                    decodeDeviceList<ATTACHED_STORAGE_DEVICE_LIST>(job.value,
+                            devices) :
+                    decodeDeviceList<ATTACHED_NONSTORAGE_DEVICE_LIST>(
+                            job.value, devices);
+
+    if (decoded) {
+        switch (job.jobType) {
+        case JOB_MERGE:
+            devices.merge();
+            break;
+        case JOB_SYNC:
+            devices.diff();
+            break;
+        case JOB_DIFF: {
+            pluginMetrics.latency(LATENCY_LIST_DECODE, decodeStartNs);
+            uint64_t diffStartNs = getMonotonicTimeNs();
+            devices.diff();
+            pluginMetrics.latency(LATENCY_LIST_DIFF, diffStartNs);
+
+            for (const auto &device : devices.disconnected())
+                push( { device, 0, false });
+            for (const auto &device : devices.connected())
+                push( { device, 0, false });
+            break;
+        }
+        }
+    }
+
+    push( { Device(), job.startNs, true });
+}
+
+void DeviceListWorker::push(const Result &result) {
+    //Bounded, so a stalled main loop holds the worker back rather than
+    //letting results pile up. The queue only fills up after a notify the
+    //main loop has not drained yet.
+    while (!mResults.push(result))
+        std::this_thread::yield();
+
+    if (!mNotified.exchange(true, std::memory_order_acq_rel)) {
+        uint64_t one = 1;
+        if (write(mNotifyFd, &one, sizeof(one)) < 0)
+            LOG_DEBUG("%s eventfd write failed", __FUNCTION__);
+    }
+}
@@ -0,0 +1,109 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "DeviceListDiff.h"
+#include "MpscQueue.h"
+#include "PdmUtils.h"
+
+#include <pbnjson.hpp>
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include <stdint.h>
+
+/*
+ * Decodes and diffs device list updates on a thread of its own. The main
+ * loop hands over each subscription response and later drains the device
+ * changes found, so all it does per update is queue a job and call the
+ * Manager with the results.
+ *
+ * Once started the worker owns the DeviceListDiffs passed in, the main
+ * loop must not touch them anymore. A posted JValue must not be modified
+ * afterwards, the worker only reads it.
+ *
+ * Jobs and results both travel through bounded lock-free queues. The
+ * worker sleeps on an eventfd the main loop signals per job. notifyFd()
+ * becomes readable when there are results to drain, the worker waits for
+ * room when the main loop falls behind.
+ */
+class DeviceListWorker {
+public:
+    enum JobType {
+        JOB_MERGE = 0, // devices attached before we started, nothing reported
+        JOB_SYNC,      // update while toasts are blocked, nothing reported
+        JOB_DIFF       // report the devices that came and went
+    };
+
+    struct Result {
+        PdmUtils::Device device;
+        // Callback time of the update, set on the end marker only
+        uint64_t startNs;
+        // Marks the end of the results of one update, device is unset
+        bool endOfUpdate;
+    };
+
+    typedef std::function<void(const Result &result)> ResultHandler;
+
+    DeviceListWorker(DeviceListDiff &storageDevices,
+            DeviceListDiff &nonStorageDevices);
+    ~DeviceListWorker();
+
+    bool start();
+
+    // Takes a deep copy of value, the caller keeps using its own.
+    // False if the job queue is full, post again once drain() ran
+    bool post(PdmUtils::EventType type, JobType jobType,
+            const pbnjson::JValue &value, uint64_t startNs);
+
+    int notifyFd() const {
+        return mNotifyFd;
+    }
+
+    // Main loop, hands every queued result to handler
+    void drain(const ResultHandler &handler);
+
+    // Spins until every posted update has been processed, for the bench
+    void waitIdle();
+
+private:
+    static const size_t JOB_QUEUE_SIZE = 64;
+    static const size_t RESULT_QUEUE_SIZE = 256;
+
+    struct Job {
+        PdmUtils::EventType type;
+        JobType jobType;
+        pbnjson::JValue value;
+        uint64_t startNs;
+    };
+
+    void run();
+    void process(Job &job);
+    void push(const Result &result);
+
+    DeviceListDiff *mLists[2];
+    std::thread mThread;
+    MpscQueue<Job, JOB_QUEUE_SIZE> mJobs;
+    int mJobFd;
+    std::atomic<unsigned int> mPending;
+    std::atomic<bool> mStop;
+    MpscQueue<Result, RESULT_QUEUE_SIZE> mResults;
+    std::atomic<bool> mNotified;
+    int mNotifyFd;
+};
@@ -19,7 +19,9 @@
 #include <unordered_map>
 
 static std::unordered_map<int, const char*> errorTexts = { {
-        ALERT_CLOSE_INVALID_ACTION, "Invalid action" } };
+        ALERT_CLOSE_INVALID_ACTION, "Invalid action" }, {
+        FLIGHT_RECORDER_DUMP_FAILED, "Failed to write flight recorder dump" }, {
+        TRACE_START_FAILED, "Failed to create trace file" } };
 
 static const char *defaultError = "Unknown Error";
 
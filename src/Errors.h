@@ -20,7 +20,9 @@
 #include <string.h>
 
 enum PluginErrorCode {
-    ALERT_CLOSE_INVALID_ACTION = 101
+    ALERT_CLOSE_INVALID_ACTION = 101,
+    FLIGHT_RECORDER_DUMP_FAILED = 102,
+    TRACE_START_FAILED = 103
 };
 
 const char* GetErrorMessage(PluginErrorCode errorCode);
@@ -0,0 +1,126 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "FlightRecorder.h"
+
+#include "PdmUtils.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+FlightRecorder pluginFlightRecorder;
+
+static_assert((FlightRecorder::CAPACITY & (FlightRecorder::CAPACITY - 1)) == 0,
+        "CAPACITY must be a power of two");
+
+FlightRecorder::FlightRecorder() :
+        mHead(0), mTriggerStage(0), mTriggerIntervalMs(0), mLastTriggerMs(0), mTriggerPending(
+                false) {
+    for (auto &slot : mSlots) {
+        slot.sequence.store(0, std::memory_order_relaxed);
+        memset(&slot.entry, 0, sizeof(slot.entry));
+    }
+}
+
+void FlightRecorder::record(FlightRecorderStage stage, int eventType,
+        int deviceNum) {
+    uint32_t sequence = mHead.fetch_add(1, std::memory_order_relaxed) + 1;
+    Slot &slot = mSlots[sequence & (CAPACITY - 1)];
+
+    //0 marks the slot as being written, see dump()
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.entry.timestampNs = PdmUtils::getMonotonicTimeNs();
+    slot.entry.sequence = sequence;
+    slot.entry.deviceNum = deviceNum;
+    slot.entry.eventType = eventType;
+    slot.entry.stage = stage;
+    slot.sequence.store(sequence, std::memory_order_release);
+
+    if (mTriggerStage && stage == mTriggerStage) {
+        uint64_t nowMs = PdmUtils::getMonotonicTimeMs();
+        uint64_t lastMs = mLastTriggerMs.load(std::memory_order_relaxed);
+        if ((!lastMs || nowMs - lastMs >= mTriggerIntervalMs)
+                && mLastTriggerMs.compare_exchange_strong(lastMs, nowMs))
+            mTriggerPending.store(true, std::memory_order_release);
+    }
+}
+
+bool FlightRecorder::dump(const std::string &path) const {
+    int fd = open(path.c_str(),
+            O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd < 0)
+        return false;
+
+    uint32_t head = mHead.load(std::memory_order_acquire);
+    uint32_t count = (head < CAPACITY) ? head : CAPACITY;
+    FlightRecorderEntry entries[64];
+    size_t buffered = 0;
+    uint32_t written = 0;
+    bool ok = true;
+
+    //Reserve the header, the final count is only known at the end
+    FlightRecorderFileHeader header = { FLIGHT_RECORDER_MAGIC,
+            FLIGHT_RECORDER_VERSION, sizeof(FlightRecorderEntry), 0, 0 };
+    ok = write(fd, &header, sizeof(header)) == sizeof(header);
+
+    for (uint32_t sequence = head - count + 1; ok && sequence <= head;
+            sequence++) {
+        const Slot &slot = mSlots[sequence & (CAPACITY - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != sequence)
+            continue;
+        entries[buffered] = slot.entry;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        //Skip entries a writer replaced while we copied them
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+            continue;
+
+        if (++buffered == sizeof(entries) / sizeof(entries[0])) {
+            ok = write(fd, entries, sizeof(entries)) == sizeof(entries);
+            written += buffered;
+            buffered = 0;
+        }
+    }
+    if (ok && buffered) {
+        ssize_t size = buffered * sizeof(FlightRecorderEntry);
+        ok = write(fd, entries, size) == size;
+        written += buffered;
+    }
+
+    header.count = written;
+    if (ok)
+        ok = pwrite(fd, &header, sizeof(header), 0) == sizeof(header);
+    close(fd);
+    return ok;
+}
+
+void FlightRecorder::setTrigger(int stage, const std::string &path,
+        unsigned int minIntervalMs) {
+    mTriggerPath = path;
+    mTriggerIntervalMs = minIntervalMs;
+    mTriggerStage = stage;
+}
+
+bool FlightRecorder::triggerPending() const {
+    return mTriggerPending.load(std::memory_order_acquire);
+}
+
+bool FlightRecorder::dumpTriggered() {
+    if (!mTriggerPending.exchange(false, std::memory_order_acq_rel))
+        return false;
+    return dump(mTriggerPath);
+}
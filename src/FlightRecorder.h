@@ -0,0 +1,107 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#include <stdint.h>
+
+enum FlightRecorderStage {
+    STAGE_SIGNAL_RECEIVED = 1,
+    STAGE_PAYLOAD_DECODED,
+    STAGE_PAYLOAD_REJECTED,     // deviceNum holds the PdmDecodeStatus
+    STAGE_LIST_UPDATE_RECEIVED,
+    STAGE_DEVICE_CONNECTED,
+    STAGE_DEVICE_DISCONNECTED,
+    STAGE_TOAST_ISSUED,
+    STAGE_TOAST_SUPPRESSED,
+    STAGE_ALERT_ISSUED,
+    STAGE_ALERT_CLOSED
+};
+
+/*
+ * Fixed-size in-memory trace of the event pipeline. Writers claim a slot
+ * with one atomic increment and never block, the oldest entries are
+ * overwritten. The buffer can be dumped to a file on demand. Recording an
+ * entry with the trigger stage only marks a dump as pending, the owner
+ * writes it from the main loop with dumpTriggered().
+ *
+ * Dump file: FlightRecorderFileHeader followed by count FlightRecorderEntry,
+ * oldest first.
+ */
+static const uint32_t FLIGHT_RECORDER_MAGIC = 0x46444d50; // "PMDF"
+static const uint16_t FLIGHT_RECORDER_VERSION = 1;
+
+struct FlightRecorderFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t entrySize;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+struct FlightRecorderEntry {
+    uint64_t timestampNs;
+    uint32_t sequence;
+    int32_t deviceNum;
+    int16_t eventType;
+    uint8_t stage;
+    uint8_t reserved;
+};
+
+class FlightRecorder {
+public:
+    static const uint32_t CAPACITY = 1024;
+
+    FlightRecorder();
+
+    void record(FlightRecorderStage stage, int eventType, int deviceNum);
+
+    // Refuses to follow a symlink at path
+    bool dump(const std::string &path) const;
+
+    // Marks a dump to path as pending whenever stage is recorded, at most
+    // once per minIntervalMs. A stage of 0 disables the trigger.
+    void setTrigger(int stage, const std::string &path,
+            unsigned int minIntervalMs);
+
+    bool triggerPending() const;
+
+    // Writes the pending trigger dump, false if none was pending or the
+    // dump failed
+    bool dumpTriggered();
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        FlightRecorderEntry entry;
+    };
+
+    Slot mSlots[CAPACITY];
+    std::atomic<uint32_t> mHead;
+    int mTriggerStage;
+    std::string mTriggerPath;
+    unsigned int mTriggerIntervalMs;
+    std::atomic<uint64_t> mLastTriggerMs;
+    std::atomic<bool> mTriggerPending;
+};
+
+extern FlightRecorder pluginFlightRecorder;
+
+#define FLIGHT_RECORD(stage, eventType, deviceNum) \
+    pluginFlightRecorder.record(stage, eventType, deviceNum)
@@ -0,0 +1,144 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "LocaleCatalog.h"
+
+#include "Logging.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//Must match tools/gen-loc-catalog.py
+static uint32_t fnv1a(const char *data, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t) data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static uint32_t mix(uint32_t hash, uint32_t seed) {
+    hash ^= seed * 0x9e3779b9u;
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+LocaleCatalog::LocaleCatalog() :
+        mData(nullptr), mSize(0), mHeader(nullptr), mSeeds(nullptr), mEntries(
+                nullptr) {
+}
+
+LocaleCatalog::~LocaleCatalog() {
+    close();
+}
+
+bool LocaleCatalog::open(const std::string &dir, const std::string &locale) {
+    close();
+
+    std::string tag = locale;
+    while (!tag.empty()) {
+        if (map(dir + "/" + tag + ".cat"))
+            return true;
+        size_t dash = tag.rfind('-');
+        tag.resize(dash == std::string::npos ? 0 : dash);
+    }
+    return map(dir + "/root.cat");
+}
+
+void LocaleCatalog::close() {
+    if (!mData)
+        return;
+
+    munmap((void*) mData, mSize);
+    mData = nullptr;
+    mSize = 0;
+    mHeader = nullptr;
+    mSeeds = nullptr;
+    mEntries = nullptr;
+}
+
+bool LocaleCatalog::map(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t) st.st_size >= sizeof(LocaleCatalogHeader))
+        data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        LOG_WARNING(MSGID_PDM_PLUGIN_INFO, 0, "Cannot map catalog %s",
+                path.c_str());
+        return false;
+    }
+
+    //Check every table lies inside the file, entries are checked on lookup
+    const LocaleCatalogHeader *header = (const LocaleCatalogHeader*) data;
+    size_t size = st.st_size;
+    uint64_t tablesEnd = sizeof(LocaleCatalogHeader)
+            + (uint64_t) header->buckets * sizeof(uint32_t)
+            + (uint64_t) header->count * sizeof(LocaleCatalogEntry);
+    if (header->magic != LOCALE_CATALOG_MAGIC
+            || header->version != LOCALE_CATALOG_VERSION
+            || (header->count && !header->buckets)
+            || tablesEnd > header->stringsOffset
+            || (uint64_t) header->stringsOffset + header->stringsSize > size) {
+        LOG_WARNING(MSGID_PDM_PLUGIN_INFO, 0, "Invalid catalog %s",
+                path.c_str());
+        munmap(data, size);
+        return false;
+    }
+
+    mData = (const char*) data;
+    mSize = size;
+    mHeader = header;
+    mSeeds = (const uint32_t*) (mData + sizeof(LocaleCatalogHeader));
+    mEntries = (const LocaleCatalogEntry*) (mSeeds + header->buckets);
+    LOG_DEBUG("%s mapped %s, %u strings", __FUNCTION__, path.c_str(),
+            header->count);
+    return true;
+}
+
+const char* LocaleCatalog::find(const std::string &source,
+        size_t *length) const {
+    if (!mData || !mHeader->count)
+        return nullptr;
+
+    uint32_t hash = fnv1a(source.data(), source.size());
+    uint32_t seed = mSeeds[mix(hash, 0) % mHeader->buckets];
+    const LocaleCatalogEntry &entry = mEntries[mix(hash, seed)
+            % mHeader->count];
+
+    uint64_t stringsEnd = (uint64_t) mHeader->stringsOffset
+            + mHeader->stringsSize;
+    if (entry.keyLength != source.size()
+            || (uint64_t) entry.keyOffset + entry.keyLength > stringsEnd
+            || (uint64_t) entry.valueOffset + entry.valueLength >= stringsEnd
+            || memcmp(mData + entry.keyOffset, source.data(), source.size()))
+        return nullptr;
+
+    *length = entry.valueLength;
+    return mData + entry.valueOffset;
+}
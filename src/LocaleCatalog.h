@@ -0,0 +1,74 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <string>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Localized strings of one locale, compiled from the cppstrings.json files
+ * by tools/gen-loc-catalog.py, which documents the layout. The file is
+ * mapped read only and looked up in place through its perfect hash index,
+ * so opening it parses nothing and lookups allocate nothing.
+ */
+static const uint32_t LOCALE_CATALOG_MAGIC = 0x54414350; // "PCAT"
+static const uint32_t LOCALE_CATALOG_VERSION = 1;
+
+struct LocaleCatalogHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint32_t buckets;
+    uint32_t stringsOffset;
+    uint32_t stringsSize;
+};
+
+struct LocaleCatalogEntry {
+    uint32_t keyOffset;
+    uint32_t keyLength;
+    uint32_t valueOffset;
+    uint32_t valueLength;
+};
+
+class LocaleCatalog {
+public:
+    LocaleCatalog();
+    ~LocaleCatalog();
+
+    // Maps the catalog for locale ("en-GB") from dir, falling back to
+    // shorter tags ("en") and then to root.cat
+    bool open(const std::string &dir, const std::string &locale);
+    void close();
+    bool isOpen() const {
+        return mData != nullptr;
+    }
+
+    // Translation of source, NUL terminated and valid until close(), or
+    // nullptr if the catalog has none
+    const char* find(const std::string &source, size_t *length) const;
+
+private:
+    bool map(const std::string &path);
+
+    const char *mData;
+    size_t mSize;
+    const LocaleCatalogHeader *mHeader;
+    const uint32_t *mSeeds;
+    const LocaleCatalogEntry *mEntries;
+};
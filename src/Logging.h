@@ -33,8 +33,23 @@ extern PmLogContext pluginLogContext;
 #define LOG_INFO(msgid, kvcount, ...) \
     PmLogInfo(pluginLogContext, msgid, kvcount, ##__VA_ARGS__)
 
+// Arguments are only evaluated when debug logging is enabled for the
+// context, so stringify() and friends cost nothing otherwise. Building with
+// PDM_DISABLE_DEBUG_LOG drops the statements while keeping format checks.
+#ifdef PDM_DISABLE_DEBUG_LOG
+#define LOG_DEBUG_ENABLED() false
+#else
+#define LOG_DEBUG_ENABLED() \
+    PmLogIsEnabled(pluginLogContext, kPmLogLevel_Debug)
+#endif
+
 #define LOG_DEBUG(fmt, ...) \
-    PmLogDebug(pluginLogContext, "%s:%s() " fmt, __FILE__, __FUNCTION__, ##__VA_ARGS__)
+    do { \
+        if (LOG_DEBUG_ENABLED()) \
+            PmLogDebug(pluginLogContext, "%s:%s() " fmt, __FILE__, __FUNCTION__, ##__VA_ARGS__); \
+    } while (0)
 
 #define MSGID_ERROR_DISPLAY_STATUS_NO_EVENT		"ERROR_DISPLAY_STATUS_NO_EVENT"
 #define MSGID_PDM_PLUGIN_INFO				"EMS_PDM_PLUGIN_INFO"
+#define MSGID_PDM_EVENT_RING				"EMS_PDM_EVENT_RING"
+#define MSGID_PDM_MESSAGE_TEMPLATE			"EMS_PDM_MESSAGE_TEMPLATE"
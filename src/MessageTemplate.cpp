@@ -0,0 +1,105 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "MessageTemplate.h"
+
+#include "Logging.h"
+
+#include <string.h>
+
+MessageTemplate::MessageTemplate() :
+        mLiteralLength(0), mMatches(true) {
+}
+
+MessageTemplate::MessageTemplate(std::string text,
+        std::initializer_list<const char*> names) :
+        mText(std::move(text)), mLiteralLength(0), mMatches(true) {
+    std::vector<bool> seen(names.size(), false);
+    size_t literalStart = 0;
+    size_t pos = 0;
+
+    while ((pos = mText.find('{', pos)) != std::string::npos) {
+        size_t end = pos + 1;
+        while (end < mText.size()
+                && ((mText[end] >= 'A' && mText[end] <= 'Z')
+                        || (mText[end] >= '0' && mText[end] <= '9')
+                        || mText[end] == '_'))
+            end++;
+        if (end == pos + 1 || end == mText.size() || mText[end] != '}') {
+            pos++;
+            continue;
+        }
+
+        size_t nameLength = end - pos - 1;
+        int slot = 0;
+        for (const char *name : names) {
+            if (strlen(name) == nameLength
+                    && !mText.compare(pos + 1, nameLength, name))
+                break;
+            slot++;
+        }
+        if (slot == (int) names.size()) {
+            LOG_WARNING(MSGID_PDM_MESSAGE_TEMPLATE, 0,
+                    "Unknown placeholder %s in \"%s\"",
+                    mText.substr(pos, nameLength + 2).c_str(), mText.c_str());
+            mMatches = false;
+            pos = end + 1;
+            continue;
+        }
+
+        if (pos > literalStart)
+            mPieces.push_back( { (uint32_t) literalStart, (uint32_t) (pos
+                    - literalStart), -1 });
+        mPieces.push_back( { 0, 0, slot });
+        mLiteralLength += pos - literalStart;
+        seen[slot] = true;
+        literalStart = pos = end + 1;
+    }
+
+    if (literalStart < mText.size()) {
+        mPieces.push_back( { (uint32_t) literalStart, (uint32_t) (mText.size()
+                - literalStart), -1 });
+        mLiteralLength += mText.size() - literalStart;
+    }
+
+    int slot = 0;
+    for (const char *name : names) {
+        if (!seen[slot++]) {
+            LOG_WARNING(MSGID_PDM_MESSAGE_TEMPLATE, 0,
+                    "Placeholder {%s} missing in \"%s\"", name, mText.c_str());
+            mMatches = false;
+        }
+    }
+}
+
+std::string MessageTemplate::renderValues(const std::string *const values[],
+        size_t count) const {
+    size_t length = mLiteralLength;
+    for (const Piece &piece : mPieces) {
+        if (piece.slot >= 0 && (size_t) piece.slot < count)
+            length += values[piece.slot]->size();
+    }
+
+    std::string rendered;
+    rendered.reserve(length);
+    for (const Piece &piece : mPieces) {
+        if (piece.slot < 0)
+            rendered.append(mText, piece.offset, piece.length);
+        else if ((size_t) piece.slot < count)
+            rendered.append(*values[piece.slot]);
+    }
+    return rendered;
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+/*
+ * Localized text with {NAME} placeholders. The text is split into literal
+ * runs and placeholder slots once, render() then only appends pieces into
+ * a buffer reserved at its final size.
+ *
+ * names lists the placeholders render() fills, in argument order. A
+ * placeholder in the text that is not listed stays in the output as is,
+ * a listed name that the text lacks is not rendered; both are logged and
+ * make matches() false.
+ */
+class MessageTemplate {
+public:
+    MessageTemplate();
+    MessageTemplate(std::string text, std::initializer_list<const char*> names);
+
+    bool matches() const {
+        return mMatches;
+    }
+
+    template<typename ... Values>
+    std::string render(const Values &... values) const {
+        const std::string *args[] = { &values..., nullptr };
+        return renderValues(args, sizeof...(values));
+    }
+
+    std::string renderValues(const std::string *const values[],
+            size_t count) const;
+
+private:
+    //Literal run of mText when slot < 0, otherwise argument slot
+    struct Piece {
+        uint32_t offset;
+        uint32_t length;
+        int slot;
+    };
+
+    std::string mText;
+    std::vector<Piece> mPieces;
+    size_t mLiteralLength;
+    bool mMatches;
+};
@@ -0,0 +1,95 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+#include <stddef.h>
+
+/*
+ * Bounded lock-free multi-producer single-consumer queue. Every cell
+ * carries a sequence number telling producers and the consumer whose turn
+ * it is, so push() is one CAS on the tail and pop() touches no shared
+ * counter at all. push() fails instead of blocking when the queue is full.
+ */
+template<typename T, size_t CAPACITY>
+class MpscQueue {
+    static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0,
+            "CAPACITY must be a power of two");
+
+public:
+    MpscQueue() :
+            mTail(0), mHead(0) {
+        for (size_t i = 0; i < CAPACITY; i++)
+            mCells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // Any thread
+    bool push(const T &item) {
+        size_t pos = mTail.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell &cell = mCells[pos & (CAPACITY - 1)];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            ptrdiff_t lag = (ptrdiff_t) sequence - (ptrdiff_t) pos;
+            if (lag == 0) {
+                if (mTail.compare_exchange_weak(pos, pos + 1,
+                        std::memory_order_relaxed)) {
+                    cell.item = item;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                //The consumer has not freed this cell yet
+                return false;
+            } else {
+                pos = mTail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Consumer thread only
+    bool pop(T &item) {
+        Cell &cell = mCells[mHead & (CAPACITY - 1)];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (sequence != mHead + 1)
+            return false;
+
+        //Leave nothing behind that keeps a resource alive
+        item = std::move(cell.item);
+        cell.item = T();
+        cell.sequence.store(mHead + CAPACITY, std::memory_order_release);
+        mHead++;
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    //Padding keeps producers and the consumer off each other's cache line,
+    //alignas() is not honored by new before C++17
+    static const size_t CACHE_LINE = 64;
+
+    Cell mCells[CAPACITY];
+    std::atomic<size_t> mTail;
+    char mTailPadding[CACHE_LINE - sizeof(std::atomic<size_t>)];
+    size_t mHead;
+    char mHeadPadding[CACHE_LINE - sizeof(size_t)];
+};
@@ -0,0 +1,68 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "OpenAlerts.h"
+
+#include "Logging.h"
+
+using namespace PdmUtils;
+
+OpenAlerts::OpenAlerts(unsigned int dedupeMs, ClockMs clock) :
+        mDedupeMs(dedupeMs), mClock(std::move(clock)), mSkipped(0) {
+}
+
+bool OpenAlerts::open(const std::string &alertId, const std::string &content) {
+    uint64_t nowMs = mClock();
+    mClosed.erase(alertId);
+    auto iter = mAlerts.find(alertId);
+    if (iter == mAlerts.end()) {
+        mAlerts.emplace(alertId, Alert { content, nowMs });
+        return true;
+    }
+
+    if (iter->second.content == content
+            && nowMs - iter->second.createdMs < mDedupeMs) {
+        LOG_DEBUG("%s %s already showing", __FUNCTION__, alertId.c_str());
+        mSkipped++;
+        return false;
+    }
+
+    iter->second = Alert { content, nowMs };
+    return true;
+}
+
+bool OpenAlerts::close(const std::string &alertId) {
+    if (mClosed.count(alertId)) {
+        LOG_DEBUG("%s %s already closed", __FUNCTION__, alertId.c_str());
+        mSkipped++;
+        return false;
+    }
+
+    //Unknown alerts may be left over from before a restart, close them too
+    mAlerts.erase(alertId);
+    mClosed.insert(alertId);
+    return true;
+}
+
+void OpenAlerts::closed(const std::string &alertId) {
+    mAlerts.erase(alertId);
+    mClosed.insert(alertId);
+}
+
+void OpenAlerts::clear() {
+    mAlerts.clear();
+    mClosed.clear();
+}
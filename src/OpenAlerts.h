@@ -0,0 +1,72 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "PdmUtils.h"
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <stdint.h>
+
+/*
+ * Alerts the plugin currently has on screen, keyed by alert id, with a key
+ * of their content. Lets the plugin skip creating an alert that is already
+ * showing unchanged and closing one that is known to be closed.
+ *
+ * The index can miss a close, e.g. when the notification service restarts,
+ * so an unchanged alert is only skipped within dedupeMs of creating it. It
+ * also starts out empty when event-monitor restarts while an alert stays
+ * on screen, so an alert is only taken as closed after a close went out or
+ * alertClosed reported it.
+ */
+class OpenAlerts {
+public:
+    OpenAlerts(unsigned int dedupeMs, PdmUtils::ClockMs clock);
+
+    // True if the alert has to be created, i.e. it is not open yet or its
+    // content changed
+    bool open(const std::string &alertId, const std::string &content);
+
+    // False if the alert is known to be closed already
+    bool close(const std::string &alertId);
+
+    // The alert went away on its own, e.g. the user dismissed it
+    void closed(const std::string &alertId);
+
+    void clear();
+
+    size_t size() const {
+        return mAlerts.size();
+    }
+    uint64_t skipped() const {
+        return mSkipped;
+    }
+
+private:
+    struct Alert {
+        std::string content;
+        uint64_t createdMs;
+    };
+
+    std::unordered_map<std::string, Alert> mAlerts;
+    std::unordered_set<std::string> mClosed;
+    unsigned int mDedupeMs;
+    PdmUtils::ClockMs mClock;
+    uint64_t mSkipped;
+};
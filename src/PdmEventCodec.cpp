@@ -0,0 +1,161 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PdmEventCodec.h"
+
+#include "Logging.h"
+#include "PdmUtils.h"
+
+#include <string.h>
+
+#define FIELD(field) (1u << PDM_FIELD_##field)
+
+// Required fields per PdmEventType, indexed by event id
+static const unsigned int requiredFields[] = {
+        FIELD(DEVICE_TYPE),                 // CONNECTING_EVENT
+        0,                                  // MAX_COUNT_REACHED_EVENT
+        FIELD(DEVICE_NUM),                  // REMOVE_BEFORE_MOUNT_EVENT
+        FIELD(DRIVE_NAME),                  // REMOVE_BEFORE_MOUNT_MTP_EVENT
+        FIELD(DEVICE_NUM),                  // UNSUPPORTED_FS_FORMAT_NEEDED_EVENT
+        FIELD(DEVICE_NUM) | FIELD(MOUNT_NAME), // FSCK_TIMED_OUT_EVENT
+        FIELD(DRIVE_INFO),                  // FORMAT_STARTED_EVENT
+        FIELD(DRIVE_INFO),                  // FORMAT_SUCCESS_EVENT
+        FIELD(DRIVE_INFO),                  // FORMAT_FAIL_EVENT
+        FIELD(DEVICE_NUM)                   // REMOVE_UNSUPPORTED_FS_EVENT
+};
+
+static_assert(sizeof(requiredFields) / sizeof(requiredFields[0])
+        == PdmUtils::REMOVE_UNSUPPORTED_FS_EVENT + 1,
+        "requiredFields must cover every PdmEventType");
+
+namespace PdmEventCodec {
+
+void clear(PdmEventRecord &record) {
+    memset(&record, 0, sizeof(record));
+    record.pdmEvent = -1;
+}
+
+const char* statusText(PdmDecodeStatus status) {
+    switch (status) {
+    case PDM_DECODE_OK:
+        return "ok";
+    case PDM_DECODE_MALFORMED:
+        return "malformed payload";
+    case PDM_DECODE_NO_EVENT:
+        return "no pdmEvent";
+    case PDM_DECODE_NO_PARAMETERS:
+        return "no parameters";
+    case PDM_DECODE_UNKNOWN_EVENT:
+        return "unknown pdmEvent";
+    case PDM_DECODE_MISSING_FIELD:
+        return "missing field";
+    }
+    return "unknown";
+}
+
+bool isBinary(const char *payload, size_t length) {
+    uint32_t magic;
+    if (length < sizeof(magic))
+        return false;
+
+    memcpy(&magic, payload, sizeof(magic));
+    return magic == PDM_EVENT_BINARY_MAGIC;
+}
+
+PdmDecodeStatus decodeBinary(const char *payload, size_t length,
+        PdmEventRecord &record) {
+    clear(record);
+
+    PdmEventBinaryHeader header;
+    if (length < sizeof(header))
+        return PDM_DECODE_MALFORMED;
+
+    //The payload may not be aligned, copy fixed size parts out
+    memcpy(&header, payload, sizeof(header));
+    if (header.magic != PDM_EVENT_BINARY_MAGIC
+            || header.version != PDM_EVENT_BINARY_VERSION
+            || header.length > length - sizeof(header)) {
+        LOG_DEBUG("%s invalid header, version %u length %u", __FUNCTION__,
+                header.version, header.length);
+        return PDM_DECODE_MALFORMED;
+    }
+
+    record.pdmEvent = header.eventId;
+
+    const char *cursor = payload + sizeof(header);
+    const char *end = cursor + header.length;
+    while (cursor < end) {
+        PdmEventBinaryField field;
+        if ((size_t) (end - cursor) < sizeof(field))
+            return PDM_DECODE_MALFORMED;
+        memcpy(&field, cursor, sizeof(field));
+        cursor += sizeof(field);
+
+        if ((size_t) (end - cursor) < field.length)
+            return PDM_DECODE_MALFORMED;
+
+        PdmStringRef value = { cursor, field.length };
+        cursor += field.length;
+
+        switch (field.tag) {
+        case PDM_FIELD_DEVICE_TYPE: {
+            int32_t deviceType;
+            if (field.length != sizeof(deviceType))
+                return PDM_DECODE_MALFORMED;
+            memcpy(&deviceType, value.data, sizeof(deviceType));
+            record.deviceType = deviceType;
+            break;
+        }
+        case PDM_FIELD_DEVICE_NUM: {
+            record.deviceNum = value;
+            break;
+        }
+        case PDM_FIELD_DRIVE_NAME: {
+            record.driveName = value;
+            break;
+        }
+        case PDM_FIELD_MOUNT_NAME: {
+            record.mountName = value;
+            break;
+        }
+        case PDM_FIELD_DRIVE_INFO: {
+            record.driveInfo = value;
+            break;
+        }
+        default: {
+            //Newer producers may add fields, skip what we don't know
+            continue;
+        }
+        }
+        record.set((PdmEventField) field.tag);
+    }
+
+    return validate(record);
+}
+
+PdmDecodeStatus validate(const PdmEventRecord &record) {
+    if (record.pdmEvent < 0
+            || record.pdmEvent > PdmUtils::REMOVE_UNSUPPORTED_FS_EVENT)
+        return PDM_DECODE_UNKNOWN_EVENT;
+
+    unsigned int required = requiredFields[record.pdmEvent];
+    if ((record.fields & required) != required)
+        return PDM_DECODE_MISSING_FIELD;
+
+    return PDM_DECODE_OK;
+}
+
+} // namespace PdmEventCodec
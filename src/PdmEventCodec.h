@@ -0,0 +1,119 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <string>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Binary pdmEvent record, an alternative to the JSON payload:
+ *
+ *   PdmEventBinaryHeader, followed by header.length bytes of fields.
+ *   Each field is a PdmEventBinaryField followed by field.length bytes.
+ *
+ * String fields are not NUL terminated, PDM_FIELD_DEVICE_TYPE carries a
+ * host-order int32_t. All values are in host byte order since producer and
+ * consumer always run on the same machine.
+ */
+static const uint32_t PDM_EVENT_BINARY_MAGIC = 0x45444d50; // "PMDE"
+static const uint16_t PDM_EVENT_BINARY_VERSION = 1;
+
+struct PdmEventBinaryHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t eventId;
+    uint32_t length;
+};
+
+struct PdmEventBinaryField {
+    uint16_t tag;
+    uint16_t length;
+};
+
+enum PdmEventField {
+    PDM_FIELD_DEVICE_TYPE = 1,
+    PDM_FIELD_DEVICE_NUM,
+    PDM_FIELD_DRIVE_NAME,
+    PDM_FIELD_MOUNT_NAME,
+    PDM_FIELD_DRIVE_INFO
+};
+
+// Non-owning view into a decoded payload
+struct PdmStringRef {
+    const char *data;
+    size_t size;
+
+    std::string str() const {
+        return std::string(data, size);
+    }
+
+    // Leading decimal digits as a number, fallback when there are none
+    int toInt(int fallback = -1) const {
+        int value = 0;
+        size_t i = 0;
+        for (; i < size && data[i] >= '0' && data[i] <= '9'; i++)
+            value = value * 10 + (data[i] - '0');
+        return i ? value : fallback;
+    }
+};
+
+// Fields of a decoded pdmEvent, string fields point into the payload
+struct PdmEventRecord {
+    int pdmEvent;
+    int deviceType;
+    unsigned int fields;
+    PdmStringRef deviceNum;
+    PdmStringRef driveName;
+    PdmStringRef mountName;
+    PdmStringRef driveInfo;
+
+    bool has(PdmEventField field) const {
+        return fields & (1u << field);
+    }
+    void set(PdmEventField field) {
+        fields |= (1u << field);
+    }
+};
+
+// Why a payload was rejected
+enum PdmDecodeStatus {
+    PDM_DECODE_OK = 0,
+    PDM_DECODE_MALFORMED,
+    PDM_DECODE_NO_EVENT,
+    PDM_DECODE_NO_PARAMETERS,
+    PDM_DECODE_UNKNOWN_EVENT,
+    PDM_DECODE_MISSING_FIELD
+};
+
+namespace PdmEventCodec {
+
+void clear(PdmEventRecord &record);
+
+const char* statusText(PdmDecodeStatus status);
+
+bool isBinary(const char *payload, size_t length);
+
+// Fills record without allocating, record strings alias payload
+PdmDecodeStatus decodeBinary(const char *payload, size_t length,
+        PdmEventRecord &record);
+
+// Checks the record carries every field its pdmEvent needs
+PdmDecodeStatus validate(const PdmEventRecord &record);
+
+} // namespace PdmEventCodec
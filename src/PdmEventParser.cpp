@@ -0,0 +1,203 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PdmEventParser.h"
+
+#include "Logging.h"
+#include "PdmUtils.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+PdmEventParser::PdmEventParser() :
+        mDepth(0), mParametersDepth(-1), mSlot(SLOT_NONE), mHasEvent(false), mHasParameters(
+                false), mStatus(PDM_DECODE_OK) {
+    PdmEventCodec::clear(mRecord);
+}
+
+PdmDecodeStatus PdmEventParser::decode(const char *payload, size_t length,
+        PdmEventRecord &record) {
+    mDepth = 0;
+    mParametersDepth = -1;
+    mSlot = SLOT_NONE;
+    mHasEvent = false;
+    mHasParameters = false;
+    mStatus = PDM_DECODE_OK;
+    PdmEventCodec::clear(mRecord);
+
+    if (!begin(pbnjson::JSchema::AllSchema()) || !feed(payload, length)
+            || !end()) {
+        return (mStatus != PDM_DECODE_OK) ? mStatus : PDM_DECODE_MALFORMED;
+    }
+
+    if (!mHasEvent)
+        return PDM_DECODE_NO_EVENT;
+    if (!mHasParameters)
+        return PDM_DECODE_NO_PARAMETERS;
+
+    if (mRecord.has(PDM_FIELD_DEVICE_NUM))
+        mRecord.deviceNum = { mDeviceNum.data(), mDeviceNum.size() };
+    if (mRecord.has(PDM_FIELD_DRIVE_NAME))
+        mRecord.driveName = { mDriveName.data(), mDriveName.size() };
+    if (mRecord.has(PDM_FIELD_MOUNT_NAME))
+        mRecord.mountName = { mMountName.data(), mMountName.size() };
+    if (mRecord.has(PDM_FIELD_DRIVE_INFO))
+        mRecord.driveInfo = { mDriveInfo.data(), mDriveInfo.size() };
+
+    record = mRecord;
+    return PdmEventCodec::validate(record);
+}
+
+bool PdmEventParser::jsonObjectOpen() {
+    if (mSlot == SLOT_PARAMETERS)
+        mParametersDepth = mDepth + 1;
+    mSlot = SLOT_NONE;
+    mDepth++;
+    return true;
+}
+
+bool PdmEventParser::jsonObjectKey(const std::string &key) {
+    mSlot = SLOT_NONE;
+
+    if (mDepth == 1) {
+        if (key == "pdmEvent") {
+            mSlot = SLOT_PDM_EVENT;
+        } else if (key == "parameters") {
+            mSlot = SLOT_PARAMETERS;
+            mHasParameters = true;
+        }
+    } else if (mDepth == mParametersDepth) {
+        if (key == "deviceType")
+            mSlot = SLOT_DEVICE_TYPE;
+        else if (key == "deviceNum")
+            mSlot = SLOT_DEVICE_NUM;
+        else if (key == "driveName")
+            mSlot = SLOT_DRIVE_NAME;
+        else if (key == "mountName")
+            mSlot = SLOT_MOUNT_NAME;
+        else if (key == "driveInfo")
+            mSlot = SLOT_DRIVE_INFO;
+    }
+    return true;
+}
+
+bool PdmEventParser::jsonObjectClose() {
+    if (mDepth == mParametersDepth)
+        mParametersDepth = -1;
+    mDepth--;
+    mSlot = SLOT_NONE;
+    return true;
+}
+
+bool PdmEventParser::jsonArrayOpen() {
+    mSlot = SLOT_NONE;
+    mDepth++;
+    return true;
+}
+
+bool PdmEventParser::jsonArrayClose() {
+    mDepth--;
+    mSlot = SLOT_NONE;
+    return true;
+}
+
+bool PdmEventParser::jsonString(const std::string &s) {
+    return setValue(s, false);
+}
+
+bool PdmEventParser::jsonNumber(const std::string &n) {
+    return setValue(n, true);
+}
+
+bool PdmEventParser::jsonNumber(int64_t number) {
+    //Only raw conversion is requested
+    return true;
+}
+
+bool PdmEventParser::jsonNumber(double &number, ConversionResultFlags asFloat) {
+    return true;
+}
+
+bool PdmEventParser::jsonBoolean(bool truth) {
+    mSlot = SLOT_NONE;
+    return true;
+}
+
+bool PdmEventParser::jsonNull() {
+    mSlot = SLOT_NONE;
+    return true;
+}
+
+pbnjson::JParser::NumberType PdmEventParser::conversionToUse() const {
+    return JNUM_CONV_RAW;
+}
+
+bool PdmEventParser::setValue(const std::string &value, bool isNumber) {
+    Slot slot = mSlot;
+    mSlot = SLOT_NONE;
+
+    switch (slot) {
+    case SLOT_PDM_EVENT: {
+        char *end = nullptr;
+        errno = 0;
+        long pdmEvent = strtol(value.c_str(), &end, 10);
+        if (!isNumber || errno || *end != '\0') {
+            mStatus = PDM_DECODE_NO_EVENT;
+            return false;
+        }
+        //Reject unknown events before the parameters are even read
+        if (pdmEvent < PdmUtils::CONNECTING_EVENT
+                || pdmEvent > PdmUtils::REMOVE_UNSUPPORTED_FS_EVENT) {
+            LOG_DEBUG("%s unknown pdmEvent: %ld", __FUNCTION__, pdmEvent);
+            mStatus = PDM_DECODE_UNKNOWN_EVENT;
+            return false;
+        }
+        mRecord.pdmEvent = pdmEvent;
+        mHasEvent = true;
+        break;
+    }
+    case SLOT_DEVICE_TYPE: {
+        if (isNumber) {
+            mRecord.deviceType = atoi(value.c_str());
+            mRecord.set(PDM_FIELD_DEVICE_TYPE);
+        }
+        break;
+    }
+    case SLOT_DEVICE_NUM: {
+        mDeviceNum.assign(value);
+        mRecord.set(PDM_FIELD_DEVICE_NUM);
+        break;
+    }
+    case SLOT_DRIVE_NAME: {
+        mDriveName.assign(value);
+        mRecord.set(PDM_FIELD_DRIVE_NAME);
+        break;
+    }
+    case SLOT_MOUNT_NAME: {
+        mMountName.assign(value);
+        mRecord.set(PDM_FIELD_MOUNT_NAME);
+        break;
+    }
+    case SLOT_DRIVE_INFO: {
+        mDriveInfo.assign(value);
+        mRecord.set(PDM_FIELD_DRIVE_INFO);
+        break;
+    }
+    default:
+        break;
+    }
+    return true;
+}
@@ -0,0 +1,79 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "PdmEventCodec.h"
+
+#include <pbnjson.hpp>
+
+#include <string>
+
+/*
+ * SAX decoder for JSON pdmEvent payloads. Only pdmEvent and the known
+ * parameters are kept, everything else is skipped without building a DOM.
+ * The parser is meant to be reused: field buffers keep their capacity, so
+ * steady state decoding does not allocate.
+ */
+class PdmEventParser: public pbnjson::JParser {
+public:
+    PdmEventParser();
+
+    // On success record strings point into this parser and stay valid
+    // until the next decode() call
+    PdmDecodeStatus decode(const char *payload, size_t length,
+            PdmEventRecord &record);
+
+protected:
+    bool jsonObjectOpen() override;
+    bool jsonObjectKey(const std::string &key) override;
+    bool jsonObjectClose() override;
+    bool jsonArrayOpen() override;
+    bool jsonArrayClose() override;
+    bool jsonString(const std::string &s) override;
+    bool jsonNumber(const std::string &n) override;
+    bool jsonNumber(int64_t number) override;
+    bool jsonNumber(double &number, ConversionResultFlags asFloat) override;
+    bool jsonBoolean(bool truth) override;
+    bool jsonNull() override;
+    NumberType conversionToUse() const override;
+
+private:
+    enum Slot {
+        SLOT_NONE,
+        SLOT_PDM_EVENT,
+        SLOT_PARAMETERS,
+        SLOT_DEVICE_TYPE,
+        SLOT_DEVICE_NUM,
+        SLOT_DRIVE_NAME,
+        SLOT_MOUNT_NAME,
+        SLOT_DRIVE_INFO
+    };
+
+    bool setValue(const std::string &value, bool isNumber);
+
+    int mDepth;
+    int mParametersDepth;
+    Slot mSlot;
+    bool mHasEvent;
+    bool mHasParameters;
+    PdmDecodeStatus mStatus;
+    PdmEventRecord mRecord;
+    std::string mDeviceNum;
+    std::string mDriveName;
+    std::string mMountName;
+    std::string mDriveInfo;
+};
@@ -0,0 +1,162 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PdmEventRing.h"
+
+#include "Logging.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+PdmEventRing::PdmEventRing() :
+        mHeader(nullptr), mSlots(nullptr), mMappedSize(0), mSlotCount(0), mSlotSize(
+                0), mReadSeq(0), mOverruns(0) {
+}
+
+PdmEventRing::~PdmEventRing() {
+    detach();
+}
+
+bool PdmEventRing::attach() {
+    if (mHeader)
+        return true;
+
+    int fd = shm_open(PDM_EVENT_RING_SHM_NAME, O_RDWR, 0);
+    if (fd < 0) {
+        LOG_DEBUG("%s no event ring, legacy segment only", __FUNCTION__);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0
+            || (size_t) st.st_size < sizeof(PdmEventRingHeader)) {
+        close(fd);
+        return false;
+    }
+
+    size_t size = st.st_size;
+    void *mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        LOG_DEBUG("%s mmap failed", __FUNCTION__);
+        return false;
+    }
+
+    PdmEventRingHeader *header = (PdmEventRingHeader*) mem;
+    uint64_t slotsSize = (uint64_t) header->slotCount * header->slotSize;
+    if (header->magic != PDM_EVENT_RING_MAGIC
+            || header->version != PDM_EVENT_RING_VERSION
+            || header->headerSize < sizeof(PdmEventRingHeader)
+            || header->slotCount == 0
+            || header->slotSize <= sizeof(PdmEventRingSlot)
+            //Every slot starts with an atomic seq, which must be aligned
+            || header->headerSize % alignof(PdmEventRingSlot) != 0
+            || header->slotSize % alignof(PdmEventRingSlot) != 0
+            || header->headerSize + slotsSize > size) {
+        LOG_WARNING(MSGID_PDM_EVENT_RING, 0,
+                "Unsupported event ring layout, version %u",
+                (unsigned int) header->version);
+        munmap(mem, size);
+        return false;
+    }
+
+    mHeader = header;
+    mMappedSize = size;
+    mSlots = (char*) mem + header->headerSize;
+    mSlotCount = header->slotCount;
+    mSlotSize = header->slotSize;
+    mRecord.reserve(mSlotSize - sizeof(PdmEventRingSlot));
+
+    //Resume where the previous consumer stopped
+    uint64_t writeSeq = mHeader->writeSeq.load(std::memory_order_acquire);
+    mReadSeq = mHeader->readSeq.load(std::memory_order_relaxed);
+    if (mReadSeq > writeSeq)
+        mReadSeq = writeSeq;
+
+    LOG_INFO(MSGID_PDM_EVENT_RING, 0, "Event ring attached, %u slots of %u bytes",
+            mSlotCount, mSlotSize);
+    return true;
+}
+
+void PdmEventRing::detach() {
+    if (!mHeader)
+        return;
+
+    munmap(mHeader, mMappedSize);
+    mHeader = nullptr;
+    mSlots = nullptr;
+    mMappedSize = 0;
+}
+
+PdmEventRingSlot* PdmEventRing::slotAt(uint64_t seq) const {
+    return (PdmEventRingSlot*) (mSlots + (seq % mSlotCount) * mSlotSize);
+}
+
+unsigned int PdmEventRing::drain(const RecordHandler &handler) {
+    if (!mHeader)
+        return 0;
+
+    unsigned int delivered = 0;
+    size_t maxLength = mSlotSize - sizeof(PdmEventRingSlot);
+
+    for (;;) {
+        uint64_t writeSeq = mHeader->writeSeq.load(std::memory_order_acquire);
+        if (mReadSeq >= writeSeq)
+            break;
+
+        if (writeSeq - mReadSeq > mSlotCount) {
+            //Producer lapped us, the oldest records are already overwritten
+            uint64_t lost = writeSeq - mReadSeq - mSlotCount;
+            mOverruns += lost;
+            mReadSeq += lost;
+            LOG_WARNING(MSGID_PDM_EVENT_RING, 0,
+                    "Event ring overrun, %llu records lost",
+                    (unsigned long long) lost);
+        }
+
+        PdmEventRingSlot *slot = slotAt(mReadSeq);
+        uint64_t committed = 2 * mReadSeq + 2;
+        uint64_t seq = slot->seq.load(std::memory_order_acquire);
+        if (seq < committed)
+            break; //Not committed yet, the next doorbell will bring us back
+
+        bool valid = (seq == committed) && (slot->length <= maxLength);
+        if (valid) {
+            const char *payload = (const char*) (slot + 1);
+            mRecord.assign(payload, payload + slot->length);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            valid = (slot->seq.load(std::memory_order_relaxed) == committed);
+        }
+
+        mReadSeq++;
+        mHeader->readSeq.store(mReadSeq, std::memory_order_release);
+
+        if (!valid) {
+            mOverruns++;
+            LOG_WARNING(MSGID_PDM_EVENT_RING, 0,
+                    "Event ring record %llu overwritten while reading",
+                    (unsigned long long) (mReadSeq - 1));
+            continue;
+        }
+
+        handler(mRecord.data(), mRecord.size());
+        delivered++;
+    }
+
+    return delivered;
+}
@@ -0,0 +1,99 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PDM_EVENT_RING_SHM_NAME "/pdm-event-ring"
+
+/*
+ * Shared memory layout of the PDM event ring.
+ *
+ * PDM is the single producer, this plugin the single consumer. Record n is
+ * stored in slot (n % slotCount). While PDM writes a slot its seq is set to
+ * 2n + 1, once the payload is complete it is set to 2n + 2 and writeSeq is
+ * advanced to n + 1. The consumer publishes the next record it will read in
+ * readSeq so PDM can see how far behind we are.
+ *
+ * A SIGUSR2 with si_value.sival_int == 0 rings the doorbell for the ring,
+ * a positive value keeps meaning "legacy segment of that many bytes".
+ * Doorbells may be merged since SIGUSR2 does not queue, every drain reads
+ * up to writeSeq so nothing is lost that way.
+ */
+static const uint32_t PDM_EVENT_RING_MAGIC = 0x524d4450; // "PDMR"
+static const uint16_t PDM_EVENT_RING_VERSION = 1;
+
+struct PdmEventRingHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t slotCount;
+    uint32_t slotSize;
+    std::atomic<uint64_t> writeSeq;
+    std::atomic<uint64_t> readSeq;
+};
+
+struct PdmEventRingSlot {
+    std::atomic<uint64_t> seq;
+    uint32_t length;
+    uint32_t reserved;
+    // payload bytes follow
+};
+
+/*
+ * Consumer side of the ring. attach() maps the ring and logs, so it and
+ * everything else here must run on the main loop, never in the signal
+ * handler.
+ */
+class PdmEventRing {
+public:
+    typedef std::function<void(const char *payload, size_t length)> RecordHandler;
+
+    PdmEventRing();
+    ~PdmEventRing();
+
+    bool attach();
+    void detach();
+    bool isAttached() const {
+        return mHeader != nullptr;
+    }
+
+    // Hands every committed record to handler in sequence order and
+    // returns the number of records delivered.
+    unsigned int drain(const RecordHandler &handler);
+
+    uint64_t overruns() const {
+        return mOverruns;
+    }
+
+private:
+    PdmEventRingSlot* slotAt(uint64_t seq) const;
+
+    PdmEventRingHeader *mHeader;
+    char *mSlots;
+    size_t mMappedSize;
+    uint32_t mSlotCount;
+    uint32_t mSlotSize;
+    uint64_t mReadSeq;
+    uint64_t mOverruns;
+    std::vector<char> mRecord;
+};
@@ -0,0 +1,112 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PdmLegacySegment.h"
+
+#include "Logging.h"
+
+#include <sys/shm.h>
+
+PdmLegacySegment::PdmLegacySegment(key_t key) :
+        mKey(key), mShmId(-1), mSegment(nullptr), mSize(0) {
+}
+
+PdmLegacySegment::~PdmLegacySegment() {
+    detach();
+}
+
+bool PdmLegacySegment::attach() {
+    //SysV ids carry a per-slot sequence number, a re-created segment never
+    //gets the id of the one we still have attached
+    int shmId = shmget(mKey, 0, 0);
+    if (shmId == -1) {
+        LOG_DEBUG("%s no pdm segment", __FUNCTION__);
+        detach();
+        return false;
+    }
+    if (shmId == mShmId)
+        return true;
+    return attachId(shmId);
+}
+
+bool PdmLegacySegment::attachId(int shmId) {
+    detach();
+
+    struct shmid_ds info;
+    if (shmctl(shmId, IPC_STAT, &info) != 0) {
+        LOG_DEBUG("%s shmctl failed for id %d", __FUNCTION__, shmId);
+        return false;
+    }
+
+    void *sharedMem = shmat(shmId, (void*) 0, SHM_RDONLY);
+    if (sharedMem == (void*) -1) {
+        LOG_DEBUG("%s no shared mem", __FUNCTION__);
+        return false;
+    }
+
+    mShmId = shmId;
+    mSegment = (const char*) sharedMem;
+    mSize = info.shm_segsz;
+    mPayload.reserve(mSize);
+    LOG_DEBUG("%s attached segment id %d size %zu", __FUNCTION__, shmId,
+            mSize);
+    return true;
+}
+
+void PdmLegacySegment::detach() {
+    if (mSegment)
+        shmdt(mSegment);
+    mShmId = -1;
+    mSegment = nullptr;
+    mSize = 0;
+}
+
+/*
+ * Copies the payload out into a buffer sized for the whole segment on
+ * attach. Only a payload behind a PdmLegacySegmentHeader can be validated,
+ * against its generation. A bare payload is taken as it is, PDM may
+ * already be overwriting it with the next event.
+ */
+PdmLegacyReadStatus PdmLegacySegment::read(unsigned int payloadLength) {
+    if (!attach())
+        return PDM_LEGACY_READ_NO_SEGMENT;
+
+    auto header = (const PdmLegacySegmentHeader*) mSegment;
+    bool versioned = mSize >= sizeof(PdmLegacySegmentHeader)
+            && header->magic == PDM_LEGACY_SEGMENT_MAGIC;
+    const char *payload = mSegment;
+    size_t capacity = mSize;
+    if (versioned) {
+        payload += sizeof(PdmLegacySegmentHeader);
+        capacity -= sizeof(PdmLegacySegmentHeader);
+    }
+    if (payloadLength > capacity)
+        return PDM_LEGACY_READ_OVERSIZED;
+
+    if (!versioned) {
+        mPayload.assign(payload, payload + payloadLength);
+        return PDM_LEGACY_READ_OK;
+    }
+
+    uint32_t generation = header->generation.load(std::memory_order_acquire);
+    if (generation & 1)
+        return PDM_LEGACY_READ_TORN;
+    mPayload.assign(payload, payload + payloadLength);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->generation.load(std::memory_order_relaxed) != generation)
+        return PDM_LEGACY_READ_TORN;
+    return PDM_LEGACY_READ_OK;
+}
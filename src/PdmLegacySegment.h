@@ -0,0 +1,76 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * Optional header at the start of the PDM_SHM_KEY segment. PDM builds that
+ * write it make generation odd while they write the payload following it
+ * and even once it is complete. Older builds put the payload at offset 0.
+ */
+static const uint32_t PDM_LEGACY_SEGMENT_MAGIC = 0x47444d50; // "PMDG"
+
+struct PdmLegacySegmentHeader {
+    uint32_t magic;
+    std::atomic<uint32_t> generation;
+};
+
+enum PdmLegacyReadStatus {
+    PDM_LEGACY_READ_OK = 0,
+    PDM_LEGACY_READ_NO_SEGMENT,
+    PDM_LEGACY_READ_OVERSIZED,  // payloadLength does not fit the segment
+    PDM_LEGACY_READ_TORN        // PDM rewrote the payload while we copied it
+};
+
+/*
+ * Reader of the SysV segment the legacy pdm protocol passes payloads in.
+ * The segment stays attached read-only between events. Each read looks the
+ * key up again, because PDM may remove and re-create the segment, even at
+ * the same size. Our attachment would keep the removed one alive with its
+ * last payload frozen in it.
+ */
+class PdmLegacySegment {
+public:
+    explicit PdmLegacySegment(key_t key);
+    ~PdmLegacySegment();
+
+    // Attaches the segment currently behind the key, if it changed
+    bool attach();
+    void detach();
+
+    PdmLegacyReadStatus read(unsigned int payloadLength);
+
+    // Valid after a read returned PDM_LEGACY_READ_OK
+    const std::vector<char>& payload() const {
+        return mPayload;
+    }
+
+private:
+    bool attachId(int shmId);
+
+    key_t mKey;
+    int mShmId;
+    const char *mSegment;
+    size_t mSize;
+    std::vector<char> mPayload;
+};
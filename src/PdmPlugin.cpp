@@ -18,10 +18,24 @@
 
 #include "config.h"
 #include "Errors.h"
+#include "FlightRecorder.h"
 #include "Logging.h"
+#include "PluginMetrics.h"
 #include <pbnjson.hpp>
 #include <functional>
 
+#include <algorithm>
+#include <atomic>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <glib-unix.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
+
 using namespace pbnjson;
 using namespace EventMonitor;
 
@@ -37,17 +51,65 @@ static const std::string PDM_ATTACHED_STORAGE_DEVICES_QUERY =
 static const std::string PDM_ATTACHED_NONSTORAGE_DEVICES_QUERY =
         "luna://com.webos.service.pdm/getAttachedNonStorageDeviceList";
 
+//Our alerts are gone when the notification service goes down
+static const std::string NOTIFICATION_SERVER_STATUS_QUERY =
+        "luna://com.webos.service.bus/signal/registerServerStatus";
+static const std::string NOTIFICATION_SERVICE_NAME = "com.webos.notification";
+
+//Our luna methods, in a category of their own since every plugin shares
+//the com.webos.service.eventmonitor bus name
+static const char *const METHOD_CATEGORY = "/pdm";
+
+//onClose action of our alerts, see PdmPlugin::alertClosed
+static const std::string ALERT_CLOSED_URI =
+        "luna://com.webos.service.eventmonitor/pdm/alertClosed";
+
 //notification Icons
 const std::string DEVICE_CONNECTED_ICON_PATH =
         "/usr/share/physical-device-manager/usb_connect.png";
 
+//Upper bound of the boot toast block, it normally ends earlier once both
+//device lists have arrived and settled for PDM_BOOT_QUIET_MS
 static const unsigned int TOAST_BOOT_BLOCK_TIME_MS = 7000;
 
+//Rejected payloads dump the flight recorder, at most once per interval
+static const unsigned int FLIGHT_RECORDER_TRIGGER_INTERVAL_MS = 60000;
+
+//Issue the subscriptions first and finish setup after the first device
+//list, see PdmPlugin::completeInit
+#ifdef PDM_DEFERRED_INIT
+static const bool DEFERRED_INIT = true;
+#else
+static const bool DEFERRED_INIT = false;
+#endif
+
+//Hold list updates back for PDM_LIST_COALESCE_DELAY_MS and only process
+//the newest one of a burst
+#ifdef PDM_LIST_COALESCE
+static const bool LIST_COALESCE = true;
+#else
+static const bool LIST_COALESCE = false;
+#endif
+
+//Record a trace to PDM_TRACE_DIR from startup so the boot toast block
+//replays faithfully
+#ifdef PDM_TRACE_AT_STARTUP
+static const bool TRACE_AT_STARTUP = true;
+#else
+static const bool TRACE_AT_STARTUP = false;
+#endif
+
+//Number of forwarded signals read per wakeup
+static const int SIGNAL_BATCH_SIZE = 16;
+
 const char *requiredServices[] = { "com.webos.service.pdm", nullptr };
 
 PmLogContext pluginLogContext;
 
-std::function<void(std::string)> cppSignalHandler = NULL;
+//Write end of the pipe signalHandler forwards SIGUSR2 through, and the
+//signals it could not forward
+static volatile sig_atomic_t signalPipeFd = -1;
+static std::atomic<uint64_t> signalsDropped(0);
 
 EventMonitor::Plugin* instantiatePlugin(int version,
         EventMonitor::Manager *manager) {
@@ -55,86 +117,284 @@ EventMonitor::Plugin* instantiatePlugin(int version,
         return nullptr;
     }
 
-    return new PdmPlugin(manager);
+    uint64_t startNs = getMonotonicTimeNs();
+    PdmPlugin *plugin = new PdmPlugin(manager);
+    pluginMetrics.startupStage(STARTUP_CONSTRUCTOR, startNs);
+    return plugin;
 }
 
-PdmPlugin::PdmPlugin(Manager *_manager) :
-        PluginBase(_manager, WEBOS_LOCALIZATION_PATH), toastsBlocked(false) {
+PdmPlugin::PdmPlugin(Manager *_manager, ClockMs clock) :
+        PluginBase(_manager, WEBOS_LOCALIZATION_PATH), toastsBlocked(false), mToastMessages(
+                [this](const std::string &text) {
+                    return this->localize(text);
+                }, [this](const std::string &text, std::string &localized) {
+                    return this->localizeStrict(text, localized);
+                }), mAlertTemplates([this](const std::string &text) {
+                    return this->localize(text);
+                }, ALERT_CLOSED_URI), mOpenAlerts(PDM_ALERT_DEDUPE_MS, clock), mToastCoalescer(
+                _manager, mToastMessages,
+                DEVICE_CONNECTED_ICON_PATH, PDM_TOAST_COALESCE_WINDOW_MS,
+                PDM_TOAST_RATE_LIMIT_MS, clock), mDebouncer(_manager,
+                PDM_DEVICE_DEBOUNCE_MS, [this](const Device &device) {
+                    mToastCoalescer.post(device.deviceType,
+                            device.deviceStatus);
+                }), mTrace(PDM_TRACE_MAX_BYTES), mLegacySegment(PDM_SHM_KEY), mLegacyPayloadsTorn(
+                0), mLegacyPayloadsOversized(0), mSignalFd(
+                -1), mSignalSource(nullptr), mSignalPipe { -1, -1 }, mSignalPipeSource(
+                nullptr), mClock(clock), mBooting(false), mBootStartMs(0), mInitialListReceived {
+                false, false }, mInitialized(!DEFERRED_INIT), mListWorkerSource(nullptr), mListUpdatesCollapsed(0) {
+    uint64_t startNs = getMonotonicTimeNs();
+    setupSignalPipe();
+
     struct sigaction act;
-    cppSignalHandler = std::bind(&PdmPlugin::handlePdmEvent, this,
-            std::placeholders::_1);
     act.sa_sigaction = signalHandler;
     sigemptyset(&act.sa_mask);
     act.sa_flags = SA_SIGINFO;
     sigaction(SIGUSR2, &act, 0);
+
+#ifdef PDM_USE_SIGNALFD
+    setupSignalFd();
+#endif
+    pluginMetrics.startupStage(STARTUP_SIGACTION, startNs);
+
+    pluginFlightRecorder.setTrigger(STAGE_PAYLOAD_REJECTED,
+            PDM_FLIGHT_RECORDER_PATH, FLIGHT_RECORDER_TRIGGER_INTERVAL_MS);
 }
 
 PdmPlugin::~PdmPlugin() {
+    if (mListWorkerSource) {
+        g_source_destroy(mListWorkerSource);
+        g_source_unref(mListWorkerSource);
+    }
+    mListWorker.reset();
+    if (mSignalSource) {
+        g_source_destroy(mSignalSource);
+        g_source_unref(mSignalSource);
+    }
+    if (mSignalFd >= 0)
+        close(mSignalFd);
+
+    signalPipeFd = -1;
+    if (mSignalPipeSource) {
+        g_source_destroy(mSignalPipeSource);
+        g_source_unref(mSignalPipeSource);
+    }
+    for (int fd : mSignalPipe) {
+        if (fd >= 0)
+            close(fd);
+    }
 }
 
-void PdmPlugin::signalHandler(int signum, siginfo_t *sig_info, void *ucontext) {
-    LOG_DEBUG("%s %d signal callback for signal number: %d", __FUNCTION__,
-            __LINE__, signum);
-    int shmId;
-    char *sharedMem;
-    unsigned int payloadLength;
-
-    if (sig_info) {
-        payloadLength = sig_info->si_value.sival_int;
-        LOG_DEBUG("%s %d payloadLength: %d", __FUNCTION__, __LINE__, payloadLength);
-        shmId = shmget(PDM_SHM_KEY, payloadLength, 0);
-        if (shmId != -1) {
-            sharedMem = (char*) shmat(shmId, (void*) 0, 0);
-
-            if (sharedMem != nullptr) {
-                std::string signalPayload(sharedMem, payloadLength);
-                shmdt(sharedMem);
-                LOG_DEBUG("%s %d payload: %s payloadLength:%d", __FUNCTION__, __LINE__, signalPayload.c_str(), payloadLength);
-                cppSignalHandler(std::move(signalPayload));
-            } else {
-                LOG_DEBUG("%s no shared mem", __FUNCTION__);
-            }
-        }
-    } else {
-        LOG_DEBUG("%s signalinfo not found", __FUNCTION__);
+void PdmPlugin::setupSignalPipe() {
+    if (pipe2(mSignalPipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+        LOG_ERROR(MSGID_PDM_PLUGIN_INFO, 0, "Failed to create signal pipe");
+        mSignalPipe[0] = mSignalPipe[1] = -1;
+        return;
     }
+
+    mSignalPipeSource = g_unix_fd_source_new(mSignalPipe[0], G_IO_IN);
+    g_source_set_callback(mSignalPipeSource,
+            (GSourceFunc) &PdmPlugin::onSignalPipeReadable, this, nullptr);
+    g_source_attach(mSignalPipeSource, g_main_context_get_thread_default());
+    signalPipeFd = mSignalPipe[1];
 }
 
-void PdmPlugin::handlePdmEvent(std::string payload) {
-    LOG_DEBUG("%s", __FUNCTION__);
-    pbnjson::JSchema parseSchema = pbnjson::JSchema::AllSchema();
+void PdmPlugin::setupSignalFd() {
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGUSR2);
 
-    pbnjson::JDomParser parser;
+    //Only this thread and the threads it starts from here on get the mask.
+    //Other event monitor threads keep taking SIGUSR2 through signalHandler,
+    //which forwards it to the main loop as well.
+    if (pthread_sigmask(SIG_BLOCK, &mask, nullptr) != 0) {
+        LOG_ERROR(MSGID_PDM_PLUGIN_INFO, 0, "Failed to block SIGUSR2");
+        return;
+    }
 
-    if (!parser.parse(payload, parseSchema)) {
-        LOG_DEBUG("%s payload parsing failed", __FUNCTION__);
+    mSignalFd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (mSignalFd < 0) {
+        LOG_ERROR(MSGID_PDM_PLUGIN_INFO, 0, "Failed to create signalfd");
+        pthread_sigmask(SIG_UNBLOCK, &mask, nullptr);
         return;
     }
 
-    pbnjson::JValue eventObject = parser.getDom();
-    if (!eventObject.hasKey("pdmEvent")) {
-        LOG_DEBUG("%s incomplete payload received", __FUNCTION__);
+    mSignalSource = g_unix_fd_source_new(mSignalFd, G_IO_IN);
+    g_source_set_callback(mSignalSource,
+            (GSourceFunc) &PdmPlugin::onSignalFdReadable,
+            this, nullptr);
+    g_source_attach(mSignalSource, g_main_context_get_thread_default());
+}
+
+gboolean PdmPlugin::onSignalFdReadable(gint fd, GIOCondition condition,
+        gpointer data) {
+    PdmPlugin *plugin = static_cast<PdmPlugin*>(data);
+    struct signalfd_siginfo infos[SIGNAL_BATCH_SIZE];
+    PdmSignal signals[SIGNAL_BATCH_SIZE];
+    ssize_t bytes;
+
+    while ((bytes = read(fd, infos, sizeof(infos))) > 0) {
+        size_t count = bytes / sizeof(struct signalfd_siginfo);
+        uint64_t nowNs = getMonotonicTimeNs();
+        for (size_t i = 0; i < count; i++)
+            signals[i] = { (int32_t) infos[i].ssi_int, 0, nowNs };
+        plugin->onPdmSignals(signals, count);
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+gboolean PdmPlugin::onSignalPipeReadable(gint fd, GIOCondition condition,
+        gpointer data) {
+    PdmPlugin *plugin = static_cast<PdmPlugin*>(data);
+    PdmSignal signals[SIGNAL_BATCH_SIZE];
+    ssize_t bytes;
+
+    //Records are written whole, so reads only ever return whole ones
+    while ((bytes = read(fd, signals, sizeof(signals))) > 0)
+        plugin->onPdmSignals(signals, bytes / sizeof(PdmSignal));
+    return G_SOURCE_CONTINUE;
+}
+
+/*
+ * Runs in whatever thread the signal hit, so it only makes async-signal-safe
+ * calls and leaves the event to the main loop. A single write() of a record
+ * smaller than PIPE_BUF is atomic, concurrent handlers do not interleave.
+ */
+void PdmPlugin::signalHandler(int signum, siginfo_t *sig_info, void *ucontext) {
+    if (!sig_info)
         return;
+
+    int savedErrno = errno;
+    PdmSignal signal = { sig_info->si_value.sival_int, 0, getMonotonicTimeNs() };
+    int fd = signalPipeFd;
+    if (fd < 0 || write(fd, &signal, sizeof(signal)) != sizeof(signal))
+        signalsDropped.fetch_add(1, std::memory_order_relaxed);
+    errno = savedErrno;
+}
+
+/*
+ * SIGUSR2 is not a realtime signal, a second one sent while the first is
+ * still pending is discarded by the kernel. That costs nothing for the
+ * event ring, one doorbell drains every committed record. The legacy
+ * protocol can lose events under bursts though, PDM also overwrites its
+ * single segment with the next payload.
+ */
+void PdmPlugin::onPdmSignals(const PdmSignal *signals, size_t count) {
+    LOG_DEBUG("%s %zu signals", __FUNCTION__, count);
+    uint64_t ringSignalNs = 0;
+    //Events may need the caches before the first device list arrived
+    completeInit();
+
+    for (size_t i = 0; i < count; i++) {
+        FLIGHT_RECORD(STAGE_SIGNAL_RECEIVED, -1, -1);
+        if (signals[i].payloadLength > 0) {
+            //Legacy protocol, the payload sits in the single PDM_SHM_KEY segment
+            readLegacySegment(signals[i].payloadLength, signals[i].timeNs);
+        } else if (!ringSignalNs) {
+            ringSignalNs = signals[i].timeNs;
+        }
     }
 
-    if (!eventObject.hasKey("parameters")) {
-        LOG_DEBUG("%s incomplete payload received no parameters", __FUNCTION__);
+    //One drain covers every doorbell of the batch
+    if (ringSignalNs)
+        drainEventRing(ringSignalNs);
+}
+
+void PdmPlugin::drainEventRing(uint64_t signalNs) {
+    //PDM may have created the ring after we started. Like startMonitoring()
+    //this runs on the main loop, so the two cannot both map the ring.
+    if (!mEventRing.attach())
         return;
+
+    auto overruns = mEventRing.overruns();
+    auto drained = mEventRing.drain(
+            [this, signalNs](const char *payload, size_t length) {
+                handlePdmEvent(payload, length, signalNs);
+            });
+    LOG_DEBUG("%s drained %u events, %llu overruns so far", __FUNCTION__,
+            drained, (unsigned long long) mEventRing.overruns());
+    if (mEventRing.overruns() != overruns) {
+        LOG_WARNING(MSGID_PDM_EVENT_RING, 0, "%llu pdm events lost in total",
+                (unsigned long long) mEventRing.overruns());
     }
+}
 
-    pbnjson::JValue params = eventObject["parameters"];
+void PdmPlugin::readLegacySegment(unsigned int payloadLength,
+        uint64_t signalNs) {
+    switch (mLegacySegment.read(payloadLength)) {
+    case PDM_LEGACY_READ_OK:
+        break;
+    case PDM_LEGACY_READ_NO_SEGMENT:
+        return;
+    case PDM_LEGACY_READ_OVERSIZED:
+        LOG_WARNING(MSGID_PDM_PLUGIN_INFO, 0,
+                "Legacy pdm payload of %u bytes does not fit the segment",
+                payloadLength);
+        mLegacyPayloadsOversized++;
+        return;
+    case PDM_LEGACY_READ_TORN:
+        LOG_WARNING(MSGID_PDM_PLUGIN_INFO, 0,
+                "Legacy pdm payload of %u bytes changed while reading it",
+                payloadLength);
+        mLegacyPayloadsTorn++;
+        return;
+    }
 
-    auto pdmEvent = eventObject["pdmEvent"].asNumber<int>();
+    const std::vector<char> &payload = mLegacySegment.payload();
+    handlePdmEvent(payload.data(), payload.size(), signalNs);
+}
+
+void PdmPlugin::handlePdmEvent(const char *payload, size_t length,
+        uint64_t signalNs) {
+    LOG_DEBUG("%s", __FUNCTION__);
+    mTrace.recordPdmEvent(payload, length);
+    PdmEventRecord record;
+    PdmDecodeStatus status;
+    uint64_t startNs = getMonotonicTimeNs();
+
+    //Binary records from newer PDM builds, JSON otherwise
+    if (PdmEventCodec::isBinary(payload, length))
+        status = PdmEventCodec::decodeBinary(payload, length, record);
+    else
+        status = mEventParser.decode(payload, length, record);
+    pluginMetrics.latency(LATENCY_PDM_EVENT_DECODE, startNs);
+
+    if (status != PDM_DECODE_OK) {
+        LOG_DEBUG("%s payload rejected: %s", __FUNCTION__,
+                PdmEventCodec::statusText(status));
+        FLIGHT_RECORD(STAGE_PAYLOAD_REJECTED, record.pdmEvent, status);
+        if (pluginFlightRecorder.triggerPending()) {
+            this->manager->setTimeout("flightRecorderDump", 0, false,
+                    [](const std::string &timeoutId) {
+                        if (!pluginFlightRecorder.dumpTriggered())
+                            LOG_DEBUG("Flight recorder dump failed");
+                    });
+        }
+        bool incomplete = (status == PDM_DECODE_NO_PARAMETERS
+                || status == PDM_DECODE_MISSING_FIELD);
+        pluginMetrics.outcome(
+                incomplete ? OUTCOME_INCOMPLETE_PAYLOAD : OUTCOME_PARSE_FAILURE);
+        return;
+    }
+
+    FLIGHT_RECORD(STAGE_PAYLOAD_DECODED, record.pdmEvent,
+            record.has(PDM_FIELD_DEVICE_NUM) ? record.deviceNum.toInt() : -1);
+    pluginMetrics.pdmEvent(record.pdmEvent);
+    dispatchPdmEvent(record);
+
+    //Events handed over outside a signal are timed from their decode
+    pluginMetrics.latency(LATENCY_PDM_EVENT_TOTAL,
+            signalNs ? signalNs : startNs);
+}
+
+//Required fields have been validated while decoding
+void PdmPlugin::dispatchPdmEvent(const PdmEventRecord &record) {
+    auto pdmEvent = record.pdmEvent;
     LOG_DEBUG("%s pdmEvent: %d", __FUNCTION__, pdmEvent);
 
     switch (pdmEvent) {
     case CONNECTING_EVENT: {
-        if (!params.hasKey("deviceType")) {
-            LOG_DEBUG("%s incomplete payload received", __FUNCTION__);
-        } else {
-            auto deviceType = params["deviceType"].asNumber<int>();
-            showConnectingToast(deviceType);
-        }
+        showConnectingToast(record.deviceType);
         break;
     }
     case MAX_COUNT_REACHED_EVENT: {
@@ -142,76 +402,36 @@ void PdmPlugin::handlePdmEvent(std::string payload) {
         break;
     }
     case REMOVE_BEFORE_MOUNT_EVENT: {
-        if (!params.hasKey("deviceNum")) {
-            LOG_DEBUG("%s incomplete payload received", __FUNCTION__);
-        } else {
-            auto deviceNum = params["deviceNum"].asString();
-            createAlertForUnmountedDeviceRemoval(std::move(deviceNum));
-        }
+        createAlertForUnmountedDeviceRemoval(record.deviceNum.str());
         break;
     }
     case REMOVE_BEFORE_MOUNT_MTP_EVENT: {
-        if (!params.hasKey("driveName")) {
-            LOG_DEBUG("%s incomplete payload received", __FUNCTION__);
-        } else {
-            auto driveName = params["driveName"].asString();
-            unMountMtpDeviceAlert(std::move(driveName));
-        }
+        unMountMtpDeviceAlert(record.driveName.str());
         break;
     }
     case UNSUPPORTED_FS_FORMAT_NEEDED_EVENT: {
-        if (!params.hasKey("deviceNum")) {
-            LOG_DEBUG("%s incomplete payload received", __FUNCTION__);
-        } else {
-            auto deviceNum = params["deviceNum"].asString();
-            createAlertForUnsupportedFileSystem(std::move(deviceNum));
-        }
+        createAlertForUnsupportedFileSystem(record.deviceNum.str());
         break;
     }
     case FSCK_TIMED_OUT_EVENT: {
-        if (!params.hasKey("deviceNum") || !params.hasKey("mountName")) {
-            LOG_DEBUG("%s incomplete payload received", __FUNCTION__);
-        } else {
-            auto deviceNum = params["deviceNum"].asString();
-            auto deviceName = params["mountName"].asString();
-            createAlertForFsckTimeout(std::move(deviceNum), std::move(deviceName));
-        }
+        createAlertForFsckTimeout(record.deviceNum.str(),
+                record.mountName.str());
         break;
     }
     case FORMAT_STARTED_EVENT: {
-        if (!params.hasKey("driveInfo")) {
-            LOG_DEBUG("%s incomplete payload received", __FUNCTION__);
-        } else {
-            auto driveInfo = params["driveInfo"].asString();
-            showFormatStartedToast(std::move(driveInfo));
-        }
+        showFormatStartedToast(record.driveInfo.str());
         break;
     }
     case FORMAT_SUCCESS_EVENT: {
-        if (!params.hasKey("driveInfo")) {
-            LOG_DEBUG("%s incomplete payload received", __FUNCTION__);
-        } else {
-            auto driveInfo = params["driveInfo"].asString();
-            showFormatSuccessToast(std::move(driveInfo));
-        }
+        showFormatSuccessToast(record.driveInfo.str());
         break;
     }
     case FORMAT_FAIL_EVENT: {
-        if (!params.hasKey("driveInfo")) {
-            LOG_DEBUG("%s incomplete payload received", __FUNCTION__);
-        } else {
-            auto driveInfo = params["driveInfo"].asString();
-            showFormatFailToast(std::move(driveInfo));
-        }
+        showFormatFailToast(record.driveInfo.str());
         break;
     }
     case REMOVE_UNSUPPORTED_FS_EVENT: {
-        if (!params.hasKey("deviceNum")) {
-            LOG_DEBUG("%s incomplete payload received", __FUNCTION__);
-        } else {
-            auto deviceNum = params["deviceNum"].asString();
-            closeUnsupportedFsAlert(std::move(deviceNum));
-        }
+        closeUnsupportedFsAlert(record.deviceNum.str());
         break;
     }
     default: {
@@ -224,143 +444,157 @@ void PdmPlugin::handlePdmEvent(std::string payload) {
 void PdmPlugin::createAlertForMaxUsbStorageDevices() {
     LOG_DEBUG("%s", __FUNCTION__);
 
-    JArray buttons = JArray { };
-    std::string message = this->getLocString(MAX_USB_DEVICE_LIMIT_REACHED);
-    buttons.append(JObject { { "label", this->getLocString("OK") }, {
-            "position", "middle" }, { "params",
-            JObject { { "action", "close" } } } });
-
-    JValue onClose = JObject { };
+    const std::string &message = mAlertTemplates.message(
+            ALERT_MESSAGE_MAX_USB_STORAGE_DEVICES);
+    if (!raiseAlert(ALERT_ID_USB_MAX_STORAGE_DEVCIES, message,
+            mAlertTemplates.okButtons(), message))
+        return;
 
-    this->manager->createAlert(ALERT_ID_USB_MAX_STORAGE_DEVCIES, "", // No title
-            message, false, "", // No icon
-            buttons, onClose);
+    pluginMetrics.outcome(OUTCOME_ALERT_ISSUED);
+    FLIGHT_RECORD(STAGE_ALERT_ISSUED, MAX_COUNT_REACHED_EVENT, -1);
 }
 
 void PdmPlugin::unMountMtpDeviceAlert(std::string driveName) {
     LOG_DEBUG("%s", __FUNCTION__);
 
-    JArray buttons = JArray { };
-    std::string message = this->getLocString(REMOVE_USB_DEVICE_BEFORE_MOUNT);
-    buttons.append(JObject { { "label", this->getLocString("OK") }, {
-            "position", "middle" }, { "params",
-            JObject { { "action", "close" } } } });
-
-    JValue onClose = JObject { };
+    const std::string &message = mAlertTemplates.message(
+            ALERT_MESSAGE_REMOVE_BEFORE_MOUNT);
+    if (!raiseAlert(ALERT_ID_USB_STORAGE_DEV_REMOVED + driveName, message,
+            mAlertTemplates.okButtons(), message))
+        return;
 
-    this->manager->createAlert(ALERT_ID_USB_STORAGE_DEV_REMOVED + driveName, "", // No title
-            message, false, "", // No icon
-            buttons, onClose);
+    pluginMetrics.outcome(OUTCOME_ALERT_ISSUED);
+    FLIGHT_RECORD(STAGE_ALERT_ISSUED, REMOVE_BEFORE_MOUNT_MTP_EVENT, -1);
 }
 
 void PdmPlugin::createAlertForUnmountedDeviceRemoval(std::string deviceNumber) {
     LOG_DEBUG("%s", __FUNCTION__);
-    std::string alertIdFsckTimeout = ALERT_ID_USB_STORAGE_FSCK_TIME_OUT
-            + deviceNumber;
-    this->manager->closeAlert(alertIdFsckTimeout);
-
-    JArray buttons = JArray { };
-    std::string message = this->getLocString(REMOVE_USB_DEVICE_BEFORE_MOUNT);
-    buttons.append(JObject { { "label", this->getLocString("OK") }, {
-            "position", "middle" }, { "params",
-            JObject { { "action", "close" } } } });
+    if (dismissAlert(ALERT_ID_USB_STORAGE_FSCK_TIME_OUT + deviceNumber)) {
+        FLIGHT_RECORD(STAGE_ALERT_CLOSED, FSCK_TIMED_OUT_EVENT,
+                atoi(deviceNumber.c_str()));
+    }
 
-    JValue onClose = JObject { };
+    const std::string &message = mAlertTemplates.message(
+            ALERT_MESSAGE_REMOVE_BEFORE_MOUNT);
+    if (!raiseAlert(ALERT_ID_USB_STORAGE_DEV_REMOVED + deviceNumber, message,
+            mAlertTemplates.okButtons(), message))
+        return;
 
-    this->manager->createAlert(ALERT_ID_USB_STORAGE_DEV_REMOVED + deviceNumber,
-            "", // No title
-            message, false, "", // No icon
-            buttons, onClose);
+    pluginMetrics.outcome(OUTCOME_ALERT_ISSUED);
+    FLIGHT_RECORD(STAGE_ALERT_ISSUED, REMOVE_BEFORE_MOUNT_EVENT,
+            atoi(deviceNumber.c_str()));
 }
 
 void PdmPlugin::createAlertForUnsupportedFileSystem(std::string deviceNumber) {
     LOG_DEBUG("%s", __FUNCTION__);
 
-    JArray buttons = JArray { };
-    std::string message = this->getLocString(USB_STORAGE_DEV_UNSUPPORTED_FS);
-    buttons.append(JObject { { "label", this->getLocString("OK") }, {
-            "position", "middle" }, { "params",
-            JObject { { "action", "close" } } } });
-
-    JValue onClose = JObject { };
+    const std::string &message = mAlertTemplates.message(
+            ALERT_MESSAGE_UNSUPPORTED_FS);
+    if (!raiseAlert(ALERT_ID_USB_STORAGE_DEV_UNSUPPORTED_FS + deviceNumber,
+            message, mAlertTemplates.okButtons(), message))
+        return;
 
-    this->manager->createAlert(
-            ALERT_ID_USB_STORAGE_DEV_UNSUPPORTED_FS + deviceNumber, "", // No title
-            message, false, "", // No icon
-            buttons, onClose);
+    pluginMetrics.outcome(OUTCOME_ALERT_ISSUED);
+    FLIGHT_RECORD(STAGE_ALERT_ISSUED, UNSUPPORTED_FS_FORMAT_NEEDED_EVENT,
+            atoi(deviceNumber.c_str()));
 }
 
 void PdmPlugin::closeUnsupportedFsAlert(std::string deviceNumber) {
     LOG_DEBUG("%s", __FUNCTION__);
-    this->manager->closeAlert(
-            ALERT_ID_USB_STORAGE_DEV_UNSUPPORTED_FS + deviceNumber);
+    if (!dismissAlert(ALERT_ID_USB_STORAGE_DEV_UNSUPPORTED_FS + deviceNumber))
+        return;
+
+    FLIGHT_RECORD(STAGE_ALERT_CLOSED, UNSUPPORTED_FS_FORMAT_NEEDED_EVENT,
+            atoi(deviceNumber.c_str()));
 }
 
 void PdmPlugin::showConnectingToast(int deviceType) {
     LOG_DEBUG("%s", __FUNCTION__);
-    std::string message = getDeviceTypeString(deviceType) + " is connecting.";
     LOG_DEBUG("%s sending toast for connecting device", __FUNCTION__);
-    message = this->getLocString(message);
-    this->manager->createToast(message, DEVICE_CONNECTED_ICON_PATH);
+    pluginMetrics.outcome(OUTCOME_TOAST_ISSUED);
+    FLIGHT_RECORD(STAGE_TOAST_ISSUED, CONNECTING_EVENT, -1);
+    this->manager->createToast(mToastMessages.connectingMessage(deviceType),
+            DEVICE_CONNECTED_ICON_PATH);
 }
 
 void PdmPlugin::createAlertForFsckTimeout(std::string deviceNumber,
         std::string deviceName) {
     LOG_DEBUG("%s", __FUNCTION__);
 
-    std::string message = this->getLocString(USB_STORAGE_FSCK_TIME_OUT);
-    pbnjson::JValue buttons = pbnjson::JArray { pbnjson::JObject { { "label",
-            this->getLocString("CHECK & REPAIR") }, { "onclick",
-            "luna://com.webos.service.pdm/mountandFullFsck" },
-            { "params", pbnjson::JObject { { "needFsck", true }, { "mountName",
-                    deviceName } } } }, pbnjson::JObject { { "label",
-            this->getLocString("OPEN NOW") }, { "onclick",
-            "luna://com.webos.service.pdm/mountandFullFsck" }, { "params",
-            pbnjson::JObject { { "needFsck", false },
-                    { "mountName", deviceName } } } } };
-
-    JValue onClose = JObject { };
-
-    this->manager->createAlert(
-            ALERT_ID_USB_STORAGE_FSCK_TIME_OUT + deviceNumber, "", // No title
+    std::string message = mAlertTemplates.fsckMessage(deviceName);
+    //The buttons carry the mount name, so it is part of the content
+    if (!raiseAlert(ALERT_ID_USB_STORAGE_FSCK_TIME_OUT + deviceNumber, message,
+            mAlertTemplates.fsckButtons(deviceName),
+            message + '\n' + deviceName))
+        return;
+
+    pluginMetrics.outcome(OUTCOME_ALERT_ISSUED);
+    FLIGHT_RECORD(STAGE_ALERT_ISSUED, FSCK_TIMED_OUT_EVENT,
+            atoi(deviceNumber.c_str()));
+}
+
+bool PdmPlugin::raiseAlert(const std::string &alertId,
+        const std::string &message, const pbnjson::JValue &buttons,
+        const std::string &content) {
+    if (!mOpenAlerts.open(alertId, content))
+        return false;
+
+    this->manager->createAlert(alertId, "", // No title
             message, false, "", // No icon
-            buttons, onClose);
+            buttons, mAlertTemplates.closeAction(alertId));
+    return true;
+}
+
+bool PdmPlugin::dismissAlert(const std::string &alertId) {
+    if (!mOpenAlerts.close(alertId))
+        return false;
+
+    this->manager->closeAlert(alertId);
+    return true;
+}
+
+pbnjson::JValue PdmPlugin::alertClosed(pbnjson::JValue &params) {
+    if (!params["alertId"].isString())
+        return LunaResponseError(ALERT_CLOSE_INVALID_ACTION);
+
+    std::string alertId = params["alertId"].asString();
+    LOG_DEBUG("%s alertId: %s", __FUNCTION__, alertId.c_str());
+    mOpenAlerts.closed(alertId);
+    FLIGHT_RECORD(STAGE_ALERT_CLOSED, -1, -1);
+    return LunaResponseSuccess();
 }
 
 void PdmPlugin::showFormatStartedToast(std::string driveInfo) {
     LOG_DEBUG("%s", __FUNCTION__);
 
-    std::map < std::string, std::string > values;
-    values.insert(pair<string, string>("DRIVEINFO", driveInfo));
-
-    std::string message = format(STORAGE_DEV_FORMAT_STARTED, std::move(values));
     LOG_DEBUG("%s sending toast for format started..", __FUNCTION__);
-    message = this->getLocString(message);
-    this->manager->createToast(message, DEVICE_CONNECTED_ICON_PATH);
+    pluginMetrics.outcome(OUTCOME_TOAST_ISSUED);
+    FLIGHT_RECORD(STAGE_TOAST_ISSUED, FORMAT_STARTED_EVENT, -1);
+    this->manager->createToast(
+            mToastMessages.formatMessage(FORMAT_MESSAGE_STARTED, driveInfo),
+            DEVICE_CONNECTED_ICON_PATH);
 }
 
 void PdmPlugin::showFormatSuccessToast(std::string driveInfo) {
     LOG_DEBUG("%s", __FUNCTION__);
 
-    std::map < std::string, std::string > values;
-    values.insert(pair<string, string>("DRIVEINFO", driveInfo));
-
-    std::string message = format(STORAGE_DEV_FORMAT_SUCCESS, std::move(values));
     LOG_DEBUG("%s sending toast for format success..", __FUNCTION__);
-    message = this->getLocString(message);
-    this->manager->createToast(message, DEVICE_CONNECTED_ICON_PATH);
+    pluginMetrics.outcome(OUTCOME_TOAST_ISSUED);
+    FLIGHT_RECORD(STAGE_TOAST_ISSUED, FORMAT_SUCCESS_EVENT, -1);
+    this->manager->createToast(
+            mToastMessages.formatMessage(FORMAT_MESSAGE_SUCCESS, driveInfo),
+            DEVICE_CONNECTED_ICON_PATH);
 }
 
 void PdmPlugin::showFormatFailToast(std::string driveInfo) {
     LOG_DEBUG("%s", __FUNCTION__);
 
-    std::map < std::string, std::string > values;
-    values.insert(pair<string, string>("DRIVEINFO", driveInfo));
-
-    std::string message = format(STORAGE_DEV_FORMAT_FAIL, std::move(values));
     LOG_DEBUG("%s sending toast for format fail..", __FUNCTION__);
-    message = this->getLocString(message);
-    this->manager->createToast(message, DEVICE_CONNECTED_ICON_PATH);
+    pluginMetrics.outcome(OUTCOME_TOAST_ISSUED);
+    FLIGHT_RECORD(STAGE_TOAST_ISSUED, FORMAT_FAIL_EVENT, -1);
+    this->manager->createToast(
+            mToastMessages.formatMessage(FORMAT_MESSAGE_FAIL, driveInfo),
+            DEVICE_CONNECTED_ICON_PATH);
 }
 
 void PdmPlugin::blockToasts(unsigned int timeMs) {
@@ -368,378 +602,522 @@ void PdmPlugin::blockToasts(unsigned int timeMs) {
     LOG_DEBUG("Toast block on");
 
     auto clearBlock = [this](const std::string &timeoutId) {
-        LOG_DEBUG("Toast block off");
-        this->toastsBlocked = false;
+        this->unblockToasts(true);
     };
 
     //Will replace previous timeout if any
     this->manager->setTimeout("toastUnblock", timeMs, false, clearBlock);
 }
 
+void PdmPlugin::unblockToasts(bool timedOut) {
+    if (!this->toastsBlocked)
+        return;
+
+    LOG_DEBUG("Toast block off");
+    this->toastsBlocked = false;
+    this->manager->cancelTimeout(timedOut ? "toastReady" : "toastUnblock");
+
+    if (mBooting) {
+        uint64_t timeToReadyMs = mClock() - mBootStartMs;
+        LOG_INFO(MSGID_PDM_PLUGIN_INFO, 0,
+                "Device toasts enabled after %llu ms%s",
+                (unsigned long long) timeToReadyMs,
+                timedOut ? ", boot block timed out" : "");
+        pluginMetrics.bootReady(timeToReadyMs, timedOut);
+        mBooting = false;
+    }
+}
+
+void PdmPlugin::noteBootListUpdate(EventType type) {
+    if (!this->toastsBlocked || !mBooting || !PDM_BOOT_QUIET_MS)
+        return;
+
+    mInitialListReceived[type] = true;
+    if (!mInitialListReceived[ATTACHED_STORAGE_DEVICE_LIST]
+            || !mInitialListReceived[ATTACHED_NONSTORAGE_DEVICE_LIST])
+        return;
+
+    //Both lists are in, wait for them to settle. Every further update
+    //replaces the timeout and so restarts the quiet period.
+    this->manager->setTimeout("toastReady", PDM_BOOT_QUIET_MS, false,
+            [this](const std::string &timeoutId) {
+                this->unblockToasts(false);
+            });
+}
+
 void PdmPlugin::startMonitoring() {
     LOG_INFO(MSGID_PDM_PLUGIN_INFO, 0, "Pdm monitoring starts");
 
+    //Older PDM builds only provide the legacy segment
+    uint64_t startNs = getMonotonicTimeNs();
+    if (!mEventRing.attach()) {
+        LOG_INFO(MSGID_PDM_PLUGIN_INFO, 0, "Using legacy pdm event segment");
+        mLegacySegment.attach();
+    }
+
+    pluginMetrics.startupStage(STARTUP_EVENT_RING, startNs);
+
+    if (TRACE_AT_STARTUP && !mTrace.recording())
+        mTrace.start(PDM_TRACE_DIR, true, JValue(), JValue());
+
+    //The virtual clock of the bench and replay may start at 0
+    mBooting = true;
+    mBootStartMs = mClock();
     this->blockToasts(TOAST_BOOT_BLOCK_TIME_MS);
 
+    if (!DEFERRED_INIT)
+        registerMethods();
+
+#ifdef PDM_LIST_WORKER
+    startListWorker();
+#endif
+
     JValue params = JObject { { } };
 
+    startNs = getMonotonicTimeNs();
     this->manager->subscribeToMethod("attachedStorageDeviceList",
             PDM_ATTACHED_STORAGE_DEVICES_QUERY, params,
             std::bind(&PdmPlugin::attachedStorageDeviceListCallback, this,
                     std::placeholders::_1, std::placeholders::_2));
+    pluginMetrics.startupStage(STARTUP_STORAGE_SUBSCRIPTION, startNs);
 
+    startNs = getMonotonicTimeNs();
     this->manager->subscribeToMethod("attachedNonStorageDeviceList",
             PDM_ATTACHED_NONSTORAGE_DEVICES_QUERY, params,
             std::bind(&PdmPlugin::attachedNonStorageDeviceListCallback, this,
                     std::placeholders::_1, std::placeholders::_2));
+    pluginMetrics.startupStage(STARTUP_NONSTORAGE_SUBSCRIPTION, startNs);
+
+    this->manager->subscribeToMethod("notificationServerStatus",
+            NOTIFICATION_SERVER_STATUS_QUERY, JObject { { "serviceName",
+                    NOTIFICATION_SERVICE_NAME } },
+            std::bind(&PdmPlugin::notificationServerStatusCallback, this,
+                    std::placeholders::_1, std::placeholders::_2));
 }
 
-EventMonitor::UnloadResult PdmPlugin::stopMonitoring(
-        const std::string &service) {
-    return UNLOAD_OK;
+void PdmPlugin::registerMethods() {
+    uint64_t startNs = getMonotonicTimeNs();
+    this->manager->registerMethod(METHOD_CATEGORY, "alertClosed",
+            std::bind(&PdmPlugin::alertClosed, this, std::placeholders::_1),
+            JObject { { "type", "object" }, { "properties", JObject { {
+                    "alertId", JObject { { "type", "string" } } } } } });
+
+    this->manager->registerMethod(METHOD_CATEGORY, "dumpFlightRecorder",
+            std::bind(&PdmPlugin::dumpFlightRecorder, this,
+                    std::placeholders::_1), JObject { { "type", "object" } });
+
+    this->manager->registerMethod(METHOD_CATEGORY, "getMetrics",
+            std::bind(&PdmPlugin::getMetrics, this, std::placeholders::_1),
+            JObject { { "type", "object" } });
+
+    this->manager->registerMethod(METHOD_CATEGORY, "setTraceRecording",
+            std::bind(&PdmPlugin::setTraceRecording, this,
+                    std::placeholders::_1),
+            JObject { { "type", "object" }, { "properties", JObject { {
+                    "enable", JObject { { "type", "boolean" } } } } }, {
+                    "required", JArray { "enable" } } });
+    pluginMetrics.startupStage(STARTUP_METHODS, startNs);
 }
 
-void PdmPlugin::attachedStorageDeviceListCallback(
-        pbnjson::JValue &previousValue, pbnjson::JValue &value) {
-    LOG_DEBUG("%s", __FUNCTION__);
+/*
+ * With PDM_DEFERRED_INIT the luna methods, the UI locale and the message
+ * caches are set up here once the first device list arrived, or right
+ * away when a pdm event or toast needs them earlier. Main loop only, pdm
+ * signals get here through onPdmSignals.
+ */
+void PdmPlugin::completeInit() {
+    if (mInitialized)
+        return;
 
-    if (!this->toastsBlocked) {
-        if (previousValue.isNull()) {
-            LOG_DEBUG("%s previousValue null", __FUNCTION__);
-            saveAlreadyConnectedDeviceList(previousValue, value,
-                    EventType::ATTACHED_STORAGE_DEVICE_LIST);
-            return;
-        } else {
-            LOG_DEBUG("%s previousValue: %s", __FUNCTION__,
-                    previousValue.stringify().c_str());
-        }
+    uint64_t startNs = getMonotonicTimeNs();
+    mInitialized = true;
+    this->manager->cancelTimeout("deferredInit");
 
-        if (value.isNull()) {
-            LOG_DEBUG("%s value null", __FUNCTION__);
-            return;
-        } else {
-            LOG_DEBUG("%s value: %s", __FUNCTION__, value.stringify().c_str());
-        }
+    registerMethods();
+    if (!mPendingLocale.empty()) {
+        applyLocale(mPendingLocale);
+        mPendingLocale.clear();
+    }
+    mToastMessages.prepare();
+    mAlertTemplates.prepare();
+    pluginMetrics.startupStage(STARTUP_DEFERRED_INIT, startNs);
+}
 
-        if (!value.hasKey("storageDeviceList"))
-            return;
+void PdmPlugin::uiLocaleChanged(const std::string &locale) {
+    LOG_DEBUG("%s locale: %s", __FUNCTION__, locale.c_str());
+    if (!mInitialized) {
+        mPendingLocale = locale;
+        return;
+    }
+    applyLocale(locale);
+}
 
-        Event event;
-        event.type = EventType::ATTACHED_STORAGE_DEVICE_LIST;
+void PdmPlugin::applyLocale(const std::string &locale) {
+    uint64_t startNs = getMonotonicTimeNs();
+#ifdef PDM_LOC_CATALOG
+    //The resource bundle is only loaded when there is no catalog to map
+    if (!mCatalog.open(PDM_LOC_CATALOG_PATH, locale))
+        PluginBase::uiLocaleChanged(locale);
+#else
+    PluginBase::uiLocaleChanged(locale);
+#endif
+    mLocale = locale;
+    mToastMessages.invalidate();
+    mAlertTemplates.invalidate();
+    pluginMetrics.startupStage(STARTUP_LOCALIZATION, startNs);
+}
 
-        JValue storageDeviceListObj = Array();
-        storageDeviceListObj = value["storageDeviceList"];
-        int storageDeviceListObjLength = storageDeviceListObj.arraySize();
+//Strings without a translation come back as the English source text, which
+//is only right for an English UI
+bool PdmPlugin::localizeStrict(const std::string &text,
+        std::string &localized) {
+    localized = localize(text);
+    bool english = mLocale.empty()
+            || (mLocale.compare(0, 2, "en") == 0
+                    && (mLocale.size() == 2 || mLocale[2] == '-'));
+    return english || localized != text;
+}
 
-        for (auto i = 0; i < storageDeviceListObjLength; i++) {
-            Device device;
-            if (!storageDeviceListObj[i].hasKey("deviceNum"))
-                continue;
+std::string PdmPlugin::localize(const std::string &text) {
+    if (!mCatalog.isOpen())
+        return this->getLocString(text);
 
-            auto deviceNum =
-                    storageDeviceListObj[i]["deviceNum"].asNumber<int>();
-            device.deviceNumber = deviceNum;
-            LOG_DEBUG("%s deviceNum: %d", __FUNCTION__, deviceNum);
+    size_t length;
+    const char *translated = mCatalog.find(text, &length);
+    return translated ? std::string(translated, length) : text;
+}
 
-            if (!storageDeviceListObj[i].hasKey("deviceType"))
-                continue;
+pbnjson::JValue PdmPlugin::dumpFlightRecorder(pbnjson::JValue &params) {
+    LOG_DEBUG("%s", __FUNCTION__);
+    if (!pluginFlightRecorder.dump(PDM_FLIGHT_RECORDER_PATH))
+        return LunaResponseError(FLIGHT_RECORDER_DUMP_FAILED);
 
-            auto deviceType = storageDeviceListObj[i]["deviceType"].asString();
-            device.deviceType = deviceType;
-            LOG_DEBUG("%s deviceType: %s", __FUNCTION__, deviceType.c_str());
-            event.devices.push_back(device);
-            event.deviceNums.insert(deviceNum);
-        }
-        handleEvent(std::move(event));
-    } else {
-        LOG_DEBUG("%s toast is blocked now", __FUNCTION__);
-        saveAlreadyConnectedDeviceList(previousValue, value,
-                EventType::ATTACHED_STORAGE_DEVICE_LIST);
+    JValue response = LunaResponseSuccess();
+    response.put("path", PDM_FLIGHT_RECORDER_PATH);
+    return response;
+}
+
+pbnjson::JValue PdmPlugin::getMetrics(pbnjson::JValue &params) {
+    LOG_DEBUG("%s", __FUNCTION__);
+    JValue response = LunaResponseSuccess();
+    JValue metrics = pluginMetrics.toJson();
+    metrics.put("toastsMerged", (int64_t) mToastCoalescer.merged());
+    metrics.put("toastsDropped", (int64_t) mToastCoalescer.dropped());
+    metrics.put("flapsCancelled", (int64_t) mDebouncer.cancelled());
+    metrics.put("eventRingOverruns", (int64_t) mEventRing.overruns());
+    metrics.put("legacyPayloadsTorn", (int64_t) mLegacyPayloadsTorn);
+    metrics.put("legacyPayloadsOversized",
+            (int64_t) mLegacyPayloadsOversized);
+    metrics.put("signalsDropped",
+            (int64_t) signalsDropped.load(std::memory_order_relaxed));
+    metrics.put("openAlerts", (int64_t) mOpenAlerts.size());
+    metrics.put("alertCallsSkipped", (int64_t) mOpenAlerts.skipped());
+    metrics.put("listUpdatesCollapsed", (int64_t) mListUpdatesCollapsed);
+    metrics.put("listHashHits", (int64_t) (mStorageDevices.hashHits()
+            + mNonStorageDevices.hashHits()));
+    metrics.put("listHashMisses", (int64_t) (mStorageDevices.hashMisses()
+            + mNonStorageDevices.hashMisses()));
+    response.put("metrics", metrics);
+    return response;
+}
+
+pbnjson::JValue PdmPlugin::setTraceRecording(pbnjson::JValue &params) {
+    LOG_DEBUG("%s", __FUNCTION__);
+    if (!params["enable"].asBool()) {
+        mTrace.stop();
+        return LunaResponseSuccess();
     }
+
+    if (!mTrace.start(PDM_TRACE_DIR, false,
+            mLastDeviceLists[EventType::ATTACHED_STORAGE_DEVICE_LIST],
+            mLastDeviceLists[EventType::ATTACHED_NONSTORAGE_DEVICE_LIST]))
+        return LunaResponseError(TRACE_START_FAILED);
+
+    JValue response = LunaResponseSuccess();
+    response.put("path", mTrace.path());
+    return response;
+}
+
+EventMonitor::UnloadResult PdmPlugin::stopMonitoring(
+        const std::string &service) {
+    mOpenAlerts.clear();
+    return UNLOAD_OK;
+}
+
+void PdmPlugin::notificationServerStatusCallback(
+        pbnjson::JValue &previousValue, pbnjson::JValue &value) {
+    LOG_DEBUG("%s connected: %d", __FUNCTION__, value["connected"].asBool());
+    if (!value["connected"].asBool())
+        mOpenAlerts.clear();
+}
+
+void PdmPlugin::attachedStorageDeviceListCallback(
+        pbnjson::JValue &previousValue, pbnjson::JValue &value) {
+    LOG_DEBUG("%s", __FUNCTION__);
+    handleDeviceListUpdate<EventType::ATTACHED_STORAGE_DEVICE_LIST>(
+            previousValue, value);
 }
 
 void PdmPlugin::attachedNonStorageDeviceListCallback(
         pbnjson::JValue &previousValue, pbnjson::JValue &value) {
     LOG_DEBUG("%s", __FUNCTION__);
+    handleDeviceListUpdate<EventType::ATTACHED_NONSTORAGE_DEVICE_LIST>(
+            previousValue, value);
+}
+
+DeviceListDiff& PdmPlugin::deviceList(EventType type) {
+    return (type == EventType::ATTACHED_STORAGE_DEVICE_LIST) ?
+            mStorageDevices : mNonStorageDevices;
+}
+
+template<EventType type>
+void PdmPlugin::handleDeviceListUpdate(pbnjson::JValue &previousValue,
+        pbnjson::JValue &value) {
+    FLIGHT_RECORD(STAGE_LIST_UPDATE_RECEIVED, type, -1);
+    pluginMetrics.startupStage(STARTUP_FIRST_SNAPSHOT, getMonotonicTimeNs());
+    if (!mInitialized) {
+        //Off the callback, so the other list is not held up
+        this->manager->setTimeout("deferredInit", 0, false,
+                [this](const std::string &timeoutId) {
+                    this->completeInit();
+                });
+    }
+    mTrace.recordDeviceList(
+            (type == EventType::ATTACHED_STORAGE_DEVICE_LIST) ?
+                    PDM_TRACE_STORAGE_LIST : PDM_TRACE_NONSTORAGE_LIST,
+            previousValue, value);
+    mLastDeviceLists[type] = value;
+    uint64_t startNs = getMonotonicTimeNs();
+
+    //The first response seeds the list and is never held back. It also
+    //replaces an update still queued from the previous subscription.
+    if (LIST_COALESCE && !previousValue.isNull()) {
+        coalesceDeviceListUpdate<type>(previousValue, value, startNs);
+    } else {
+        dropPendingDeviceList(type);
+        processDeviceListUpdate<type>(previousValue, value, startNs);
+    }
+}
 
-    if (!this->toastsBlocked) {
+static const char* listFlushTimeoutId(EventType type) {
+    return (type == EventType::ATTACHED_STORAGE_DEVICE_LIST) ?
+            "storageListFlush" : "nonStorageListFlush";
+}
+
+void PdmPlugin::dropPendingDeviceList(EventType type) {
+    PendingDeviceList &pending = mPendingLists[type];
+    if (!pending.queued)
+        return;
+
+    LOG_DEBUG("%s dropping queued update", __FUNCTION__);
+    this->manager->cancelTimeout(listFlushTimeoutId(type));
+    pending = PendingDeviceList();
+    mListUpdatesCollapsed++;
+}
+
+template<EventType type>
+void PdmPlugin::coalesceDeviceListUpdate(pbnjson::JValue &previousValue,
+        pbnjson::JValue &value, uint64_t startNs) {
+    PendingDeviceList &pending = mPendingLists[type];
+    if (pending.queued) {
+        //The diff against the committed list covers the updates in between
+        LOG_DEBUG("%s replacing queued update", __FUNCTION__);
+        mListUpdatesCollapsed++;
+        pending.value = value;
+        return;
+    }
+
+    pending.queued = true;
+    pending.previousValue = previousValue;
+    pending.value = value;
+    pending.startNs = startNs;
+
+    auto flush = [this](const std::string &timeoutId) {
+        PendingDeviceList &pending = mPendingLists[type];
+        JValue previousValue = pending.previousValue;
+        JValue value = pending.value;
+        pending.queued = false;
+        pending.previousValue = JValue();
+        pending.value = JValue();
+        processDeviceListUpdate<type>(previousValue, value, pending.startNs);
+    };
+    this->manager->setTimeout(listFlushTimeoutId(type),
+            PDM_LIST_COALESCE_DELAY_MS, false, flush);
+}
+
+template<EventType type>
+void PdmPlugin::processDeviceListUpdate(pbnjson::JValue &previousValue,
+        pbnjson::JValue &value, uint64_t startNs) {
+    if (mListWorker) {
+        DeviceListWorker::JobType jobType = DeviceListWorker::JOB_DIFF;
         if (previousValue.isNull()) {
-            LOG_DEBUG("%s previousValue null", __FUNCTION__);
-            saveAlreadyConnectedDeviceList(previousValue, value,
-                    EventType::ATTACHED_NONSTORAGE_DEVICE_LIST);
-            return;
-        } else {
-            LOG_DEBUG("%s previousValue: %s", __FUNCTION__,
-                    previousValue.stringify().c_str());
+            jobType = DeviceListWorker::JOB_MERGE;
+        } else if (this->toastsBlocked) {
+            pluginMetrics.outcome(OUTCOME_TOAST_BLOCKED);
+            jobType = DeviceListWorker::JOB_SYNC;
         }
+        //Keep the order of the updates behind one already parked
+        if (mParkedListJobs[type].queued
+                || !mListWorker->post(type, jobType, value, startNs))
+            parkListJob(type, jobType, value, startNs);
+        if (jobType != DeviceListWorker::JOB_DIFF)
+            noteBootListUpdate(type);
+        return;
+    }
 
-        if (value.isNull()) {
-            LOG_DEBUG("%s value null", __FUNCTION__);
-            return;
+    if (this->toastsBlocked || previousValue.isNull()) {
+        LOG_DEBUG("%s toast is blocked now or first response", __FUNCTION__);
+        if (previousValue.isNull()) {
+            saveAlreadyConnectedDeviceList<type>(previousValue, value);
         } else {
-            LOG_DEBUG("%s value: %s", __FUNCTION__, value.stringify().c_str());
+            //Keep the list current so the first toast after the block is
+            //about a real change
+            pluginMetrics.outcome(OUTCOME_TOAST_BLOCKED);
+            if (decodeDeviceList<type>(value, deviceList(type)))
+                deviceList(type).diff();
         }
+        noteBootListUpdate(type);
+        return;
+    }
 
-        if (!value.hasKey("nonStorageDeviceList"))
-            return;
+    LOG_DEBUG("%s previousValue: %s", __FUNCTION__,
+            previousValue.stringify().c_str());
 
-        Event event;
-        event.type = EventType::ATTACHED_NONSTORAGE_DEVICE_LIST;
-
-        JValue nonStorageDeviceListObj = Array();
-        nonStorageDeviceListObj = value["nonStorageDeviceList"];
-        int nonStorageDeviceListObjLength = nonStorageDeviceListObj.arraySize();
-
-        for (auto i = 0; i < nonStorageDeviceListObjLength; i++) {
-            Device device;
-            if (!nonStorageDeviceListObj[i].hasKey("deviceNum"))
-                continue;
-
-            auto deviceNum = nonStorageDeviceListObj[i]["deviceNum"].asNumber<
-                    int>();
-            device.deviceNumber = deviceNum;
-            LOG_DEBUG("%s deviceNum: %d", __FUNCTION__, deviceNum);
-
-            if (!nonStorageDeviceListObj[i].hasKey("deviceType"))
-                continue;
-
-            auto deviceType =
-                    nonStorageDeviceListObj[i]["deviceType"].asString();
-            device.deviceType = std::move(deviceType);
-            LOG_DEBUG("%s deviceType: %s", __FUNCTION__,
-                    device.deviceType.c_str());
-            event.devices.push_back(device);
-            event.deviceNums.insert(deviceNum);
-        }
-        handleEvent(std::move(event));
+    if (value.isNull()) {
+        LOG_DEBUG("%s value null", __FUNCTION__);
+        return;
     } else {
-        LOG_DEBUG("%s toast is blocked now", __FUNCTION__);
-        saveAlreadyConnectedDeviceList(previousValue, value,
-                EventType::ATTACHED_NONSTORAGE_DEVICE_LIST);
+        LOG_DEBUG("%s value: %s", __FUNCTION__, value.stringify().c_str());
     }
+
+    bool decoded = decodeDeviceList<type>(value, deviceList(type));
+    pluginMetrics.latency(LATENCY_LIST_DECODE, startNs);
+    if (!decoded)
+        return;
+
+    handleEvent(type);
+    pluginMetrics.latency(LATENCY_LIST_TOTAL, startNs);
 }
 
-void PdmPlugin::handleEvent(Event event) {
+void PdmPlugin::handleEvent(EventType type) {
     LOG_DEBUG("%s", __FUNCTION__);
+    completeInit();
 
-    auto &mDevices =
-            (event.type == EventType::ATTACHED_STORAGE_DEVICE_LIST) ?
-                    mStorageDevices : mNonStorageDevices;
-    std::set<int> deviceNums;
-    for (auto &device : event.devices) {
-        auto foundDevice = mDevices.find(device.deviceNumber);
-        if (foundDevice != mDevices.end()) {
-            LOG_DEBUG("%s device entry found for deviceNum %d", __FUNCTION__,
-                    device.deviceNumber);
-        } else {
-            //New device entry
-            //Handle multiple device entries for same device number
-            LOG_DEBUG("%s deviceNum %d deviceType %s new entry", __FUNCTION__,
-                    device.deviceNumber, device.deviceType);
-            device.deviceStatus = "connected.";
-            mNewDevices.insert( { device.deviceNumber, device });
-            deviceNums.insert(device.deviceNumber);
-        }
-    }
-    if (event.devices.empty()) {
-        //All connected devices are removed or no connected device exists so send Disconnected toast for all devices
-        LOG_DEBUG(
-                "%s All connected devices are removed or no connected device exists",
-                __FUNCTION__);
-        for (const auto& device : mDevices) {
-            std::string message;
-            getToastText(message, device.second.deviceType, "disconnected.");
-            LOG_DEBUG("%s sending toast for disconnected device num: %d",
-                    __FUNCTION__, device.second.deviceNumber);
-            message = this->getLocString(message);
-            this->manager->createToast(message, DEVICE_CONNECTED_ICON_PATH);
-        }
-        mDevices.clear();
+    auto &mDevices = deviceList(type);
+    uint64_t startNs = getMonotonicTimeNs();
+    mDevices.diff();
+    pluginMetrics.latency(LATENCY_LIST_DIFF, startNs);
+
+    for (const auto &device : mDevices.disconnected())
+        reportDevice(device);
+    for (const auto &device : mDevices.connected())
+        reportDevice(device);
+}
+
+void PdmPlugin::reportDevice(const Device &device) {
+    if (device.deviceStatus == DEVICE_CONNECTED) {
+        LOG_DEBUG("%s sending toast for connected devicenumber: %d type: %d",
+                __FUNCTION__, device.deviceNumber, device.deviceType);
+        FLIGHT_RECORD(STAGE_DEVICE_CONNECTED, device.deviceType,
+                device.deviceNumber);
     } else {
-        //Check if any devices are removed/disconnected
-        LOG_DEBUG("%s Check if any devices are removed/disconnected",
-                __FUNCTION__);
-        auto it = mDevices.begin();
-        while (it != mDevices.end()) {
-            if (event.deviceNums.find(it->first) == event.deviceNums.cend()) {
-                LOG_DEBUG("%s deviceNum %d device has been disconnected",
-                        __FUNCTION__, it->first);
-                //Device has been disconnected
-                std::string message;
-                getToastText(message, it->second.deviceType, "disconnected.");
-                LOG_DEBUG("%s sending toast for disconnected devicenumber: %d",
-                        __FUNCTION__, it->second.deviceNumber);
-                message = this->getLocString(message);
-                this->manager->createToast(message, DEVICE_CONNECTED_ICON_PATH);
-                it = mDevices.erase(it);
-            } else {
-                ++it;
-            }
-        }
+        LOG_DEBUG("%s sending toast for disconnected devicenumber: %d",
+                __FUNCTION__, device.deviceNumber);
+        FLIGHT_RECORD(STAGE_DEVICE_DISCONNECTED, device.deviceType,
+                device.deviceNumber);
     }
-    processNewEntries(deviceNums, mNewDevices, mDevices);
+    pluginMetrics.device(device.deviceType, device.deviceStatus);
+    mDebouncer.post(device);
 }
 
-void PdmPlugin::processNewEntries(std::set<int> &deviceNums,
-        std::unordered_multimap<int, Device> &newDevices,
-        std::unordered_map<int, Device> &mDevices) {
-    LOG_DEBUG("%s", __FUNCTION__);
+bool PdmPlugin::startListWorker() {
+    std::unique_ptr<DeviceListWorker> worker(
+            new DeviceListWorker(mStorageDevices, mNonStorageDevices));
+    if (!worker->start())
+        return false;
+
+    mListWorker = std::move(worker);
+    mListWorkerSource = g_unix_fd_source_new(mListWorker->notifyFd(), G_IO_IN);
+    g_source_set_callback(mListWorkerSource,
+            (GSourceFunc) &PdmPlugin::onListWorkerReadable, this, nullptr);
+    g_source_attach(mListWorkerSource, g_main_context_get_thread_default());
+    return true;
+}
 
-    for (auto x : deviceNums) {
-        auto count = newDevices.count(x);
-        LOG_DEBUG("%s deviceNum %d count %zu ", __FUNCTION__, x, count);
-
-        if (count && (newDevices.find(x) != newDevices.end())) {
-            Device device = newDevices.find(x)->second;
-            //If count is 1, then deviceType is always proper
-            if (count >= 2) {
-                auto range = newDevices.equal_range(device.deviceNumber);
-                std::string deviceType;
-                for (auto it = range.first; it != range.second; ++it) {
-                    deviceType = getDeviceType(deviceType,
-                            it->second.deviceType);
-                }
-                device.deviceType = deviceType;
-                LOG_DEBUG("%s actual deviceType: %s", __FUNCTION__,
-                        deviceType.c_str());
-            }
-
-            LOG_DEBUG("%s updated deviceType: %s", __FUNCTION__,
-                    device.deviceType.c_str());
-            mDevices.insert( { device.deviceNumber, device }); //save device entry
-            //Display device toast
-            std::string message;
-            getToastText(message, device.deviceType, device.deviceStatus);
-            LOG_DEBUG(
-                    "%s sending toast for connected devicenumber: %d type: %s msg: %s",
-                    __FUNCTION__, device.deviceNumber,
-                    device.deviceType.c_str(), message.c_str());
-            message = this->getLocString(message);
-            this->manager->createToast(message, DEVICE_CONNECTED_ICON_PATH);
-        }
+gboolean PdmPlugin::onListWorkerReadable(gint fd, GIOCondition condition,
+        gpointer data) {
+    PdmPlugin *plugin = static_cast<PdmPlugin*>(data);
+    plugin->drainListWorker();
+    plugin->postParkedListJobs();
+    return G_SOURCE_CONTINUE;
+}
+
+void PdmPlugin::parkListJob(EventType type, DeviceListWorker::JobType jobType,
+        pbnjson::JValue &value, uint64_t startNs) {
+    ParkedListJob &parked = mParkedListJobs[type];
+    if (parked.queued) {
+        //The diff against the committed list covers the updates in between,
+        //a merge or sync still parked must not turn into a reporting diff
+        LOG_DEBUG("%s replacing parked update", __FUNCTION__);
+        mListUpdatesCollapsed++;
+        parked.jobType = std::min(parked.jobType, jobType);
+        parked.value = value;
+        return;
     }
-    newDevices.clear();
+
+    LOG_DEBUG("%s worker queue full, parking update", __FUNCTION__);
+    parked.queued = true;
+    parked.jobType = jobType;
+    parked.value = value;
+    parked.startNs = startNs;
 }
 
-std::string PdmPlugin::getDeviceType(std::string current,
-        std::string received) {
-    LOG_DEBUG("%s current: %s received: %s", __FUNCTION__, current.c_str(),
-            received.c_str());
-    if (current.empty()) {
-        current = std::move(received);
-    } else if ((0 == current.compare("HID"))
-            && (0 != received.compare("HID"))) {
-        current = std::move(received);
-    } else if ((0 == current.compare("SOUND"))
-            && (0 == received.compare("CAM"))) {
-        current = std::move(received);
+void PdmPlugin::postParkedListJobs() {
+    for (int type = 0; type < 2; type++) {
+        ParkedListJob &parked = mParkedListJobs[type];
+        if (!parked.queued)
+            continue;
+        //Still full, the worker signals again once it has moved on
+        if (!mListWorker->post(static_cast<EventType>(type), parked.jobType,
+                parked.value, parked.startNs))
+            continue;
+        parked = ParkedListJob();
     }
-    LOG_DEBUG("%s new current: %s", __FUNCTION__, current.c_str());
-    return current;
 }
 
-void PdmPlugin::saveAlreadyConnectedDeviceList(pbnjson::JValue &previousValue,
-        pbnjson::JValue &value, EventType eventType) {
-    LOG_DEBUG("%s", __FUNCTION__);
-    if (previousValue.isNull()) {
-        LOG_DEBUG("%s previousValue null", __FUNCTION__);
-        if (value.isNull()) {
-            LOG_DEBUG("%s value null, nothing to save", __FUNCTION__);
+void PdmPlugin::drainListWorker() {
+    mListWorker->drain([this](const DeviceListWorker::Result &result) {
+        if (result.endOfUpdate) {
+            pluginMetrics.latency(LATENCY_LIST_TOTAL, result.startNs);
             return;
-        } else {
-            LOG_DEBUG("%s value: %s", __FUNCTION__, value.stringify().c_str());
-
-            switch (eventType) {
-            case EventType::ATTACHED_NONSTORAGE_DEVICE_LIST: {
-                if (!value.hasKey("nonStorageDeviceList"))
-                    return;
-                JValue nonStorageDeviceListObj = Array();
-                nonStorageDeviceListObj = value["nonStorageDeviceList"];
-                int nonStorageDeviceListObjLength =
-                        nonStorageDeviceListObj.arraySize();
-
-                for (auto i = 0; i < nonStorageDeviceListObjLength; i++) {
-                    Device device;
-                    if (!nonStorageDeviceListObj[i].hasKey("deviceNum"))
-                        continue;
-
-                    auto deviceNum =
-                            nonStorageDeviceListObj[i]["deviceNum"].asNumber<int>();
-                    device.deviceNumber = deviceNum;
-                    LOG_DEBUG("%s deviceNum: %d", __FUNCTION__, deviceNum);
-
-                    if (!nonStorageDeviceListObj[i].hasKey("deviceType"))
-                        continue;
-
-                    auto deviceType =
-                            nonStorageDeviceListObj[i]["deviceType"].asString();
-                    device.deviceType = deviceType;
-                    LOG_DEBUG("%s deviceType: %s", __FUNCTION__,
-                            deviceType.c_str());
-                    auto found = mNonStorageDevices.find(deviceNum);
-                    if (found != mNonStorageDevices.end()) {
-                        found->second.deviceType = getDeviceType(
-                                found->second.deviceType, device.deviceType);
-                        LOG_DEBUG("%s proper deviceType: %s", __FUNCTION__,
-                                found->second.deviceType.c_str());
-                    } else {
-                        mNonStorageDevices.insert(
-                                { device.deviceNumber, device });
-                        LOG_DEBUG("%s new deviceType: %s", __FUNCTION__,
-                                device.deviceType.c_str());
-                    }
-                }
-                break;
-            }
-            case EventType::ATTACHED_STORAGE_DEVICE_LIST: {
-                if (!value.hasKey("storageDeviceList"))
-                    return;
-                JValue storageDeviceListObj = Array();
-                storageDeviceListObj = value["storageDeviceList"];
-                int storageDeviceListObjLength =
-                        storageDeviceListObj.arraySize();
-
-                for (auto i = 0; i < storageDeviceListObjLength; i++) {
-                    Device device;
-                    if (!storageDeviceListObj[i].hasKey("deviceNum"))
-                        continue;
-
-                    auto deviceNum =
-                            storageDeviceListObj[i]["deviceNum"].asNumber<int>();
-                    device.deviceNumber = deviceNum;
-                    LOG_DEBUG("%s deviceNum: %d", __FUNCTION__, deviceNum);
-
-                    if (!storageDeviceListObj[i].hasKey("deviceType"))
-                        continue;
-
-                    auto deviceType =
-                            storageDeviceListObj[i]["deviceType"].asString();
-                    device.deviceType = deviceType;
-                    LOG_DEBUG("%s deviceType: %s", __FUNCTION__,
-                            deviceType.c_str());
-
-                    auto found = mStorageDevices.find(deviceNum);
-                    if (found != mStorageDevices.end()) {
-                        found->second.deviceType = getDeviceType(
-                                found->second.deviceType, device.deviceType);
-                        LOG_DEBUG("%s proper deviceType: %s", __FUNCTION__,
-                                found->second.deviceType.c_str());
-                    } else {
-                        mStorageDevices.insert(
-                                { device.deviceNumber, device });
-                    }
-                }
-                break;
-            }
-            default: {
-                LOG_DEBUG("%s Unknown event type %s", __FUNCTION__,
-                        value.stringify().c_str());
-            }
-            }
         }
-    } else {
+        completeInit();
+        reportDevice(result.device);
+    });
+}
+
+template<EventType type>
+void PdmPlugin::saveAlreadyConnectedDeviceList(pbnjson::JValue &previousValue,
+        pbnjson::JValue &value) {
+    LOG_DEBUG("%s", __FUNCTION__);
+    if (!previousValue.isNull()) {
         LOG_DEBUG(
                 "%s previousValue not null, hence not on boot device status : %s",
                 __FUNCTION__, previousValue.stringify().c_str());
+        return;
     }
+
+    LOG_DEBUG("%s previousValue null", __FUNCTION__);
+    if (value.isNull()) {
+        LOG_DEBUG("%s value null, nothing to save", __FUNCTION__);
+        return;
+    }
+
+    LOG_DEBUG("%s value: %s", __FUNCTION__, value.stringify().c_str());
+
+    auto &devices = deviceList(type);
+    if (!decodeDeviceList<type>(value, devices))
+        return;
+
+    devices.merge();
 }
@@ -16,42 +16,106 @@
 
 #pragma once
 
+#include "AlertTemplates.h"
+#include "DeviceDebouncer.h"
+#include "DeviceListDecoder.h"
+#include "DeviceListDiff.h"
+#include "DeviceListWorker.h"
+#include "LocaleCatalog.h"
+#include "OpenAlerts.h"
+#include "PdmEventCodec.h"
+#include "PdmEventParser.h"
+#include "PdmEventRing.h"
+#include "PdmLegacySegment.h"
+#include "PdmTrace.h"
 #include "PdmUtils.h"
+#include "ToastCoalescer.h"
+#include "ToastMessageCache.h"
 
 #include <event-monitor-api/pluginbase.hpp>
 
-#include <sys/shm.h>
+#include <glib.h>
 
-#include <set>
+#include <atomic>
 #include <map>
-#include <unordered_map>
+#include <memory>
+#include <vector>
 
 #define PDM_SHM_KEY 45697
 
 using namespace PdmUtils;
 
 class PdmPlugin: public EventMonitor::PluginBase {
+    friend class PdmPluginBench;
+    friend class PdmTraceReplay;
 public:
-    PdmPlugin(EventMonitor::Manager *manager);
+    PdmPlugin(EventMonitor::Manager *manager, ClockMs clock =
+            getMonotonicTimeMs);
     virtual ~PdmPlugin();
     void startMonitoring();
     EventMonitor::UnloadResult stopMonitoring(const std::string &service);
+    void uiLocaleChanged(const std::string &locale) override;
 
 private:
+    void registerMethods();
+    void completeInit();
+    void applyLocale(const std::string &locale);
+    std::string localize(const std::string &text);
+    bool localizeStrict(const std::string &text, std::string &localized);
     void attachedStorageDeviceListCallback(pbnjson::JValue &previousValue,
             pbnjson::JValue &value);
     void attachedNonStorageDeviceListCallback(pbnjson::JValue &previousValue,
             pbnjson::JValue &value);
+    void notificationServerStatusCallback(pbnjson::JValue &previousValue,
+            pbnjson::JValue &value);
     void blockToasts(unsigned int timeMs);
-    void handleEvent(Event event);
+    void unblockToasts(bool timedOut);
+    void noteBootListUpdate(EventType type);
+    DeviceListDiff& deviceList(EventType type);
+    template<EventType type>
+    void handleDeviceListUpdate(pbnjson::JValue &previousValue,
+            pbnjson::JValue &value);
+    void dropPendingDeviceList(EventType type);
+    template<EventType type>
+    void coalesceDeviceListUpdate(pbnjson::JValue &previousValue,
+            pbnjson::JValue &value, uint64_t startNs);
+    template<EventType type>
+    void processDeviceListUpdate(pbnjson::JValue &previousValue,
+            pbnjson::JValue &value, uint64_t startNs);
+    void handleEvent(EventType type);
+    void reportDevice(const Device &device);
+    bool startListWorker();
+    static gboolean onListWorkerReadable(gint fd, GIOCondition condition,
+            gpointer data);
+    void drainListWorker();
+    void parkListJob(EventType type, DeviceListWorker::JobType jobType,
+            pbnjson::JValue &value, uint64_t startNs);
+    void postParkedListJobs();
+    template<EventType type>
     void saveAlreadyConnectedDeviceList(pbnjson::JValue &previousValue,
-            pbnjson::JValue &value, EventType);
-    void processNewEntries(std::set<int> &deviceNums,
-            std::unordered_multimap<int, Device> &newDevices,
-            std::unordered_map<int, Device> &mCurrentDevices);
-    std::string getDeviceType(std::string current, std::string received);
+            pbnjson::JValue &value);
+    //SIGUSR2 as forwarded to the main loop
+    struct PdmSignal {
+        int32_t payloadLength;
+        uint32_t reserved;
+        uint64_t timeNs;
+    };
+
     static void signalHandler(int signum, siginfo_t *sig_info, void *ucontext);
-    void handlePdmEvent(std::string payload);
+    void setupSignalPipe();
+    static gboolean onSignalPipeReadable(gint fd, GIOCondition condition,
+            gpointer data);
+    void setupSignalFd();
+    static gboolean onSignalFdReadable(gint fd, GIOCondition condition,
+            gpointer data);
+    void onPdmSignals(const PdmSignal *signals, size_t count);
+    void drainEventRing(uint64_t signalNs);
+    void readLegacySegment(unsigned int payloadLength, uint64_t signalNs);
+    // signalNs is when the signal announcing the payload arrived, 0 times
+    // the event from its decode
+    void handlePdmEvent(const char *payload, size_t length,
+            uint64_t signalNs = 0);
+    void dispatchPdmEvent(const PdmEventRecord &record);
     void createAlertForMaxUsbStorageDevices();
     void unMountMtpDeviceAlert(std::string driveName);
     void createAlertForUnmountedDeviceRemoval(std::string deviceNumber);
@@ -59,13 +123,73 @@ private:
     void closeUnsupportedFsAlert(std::string deviceNumber);
     void createAlertForFsckTimeout(std::string deviceNumber,
             std::string deviceName);
+    bool raiseAlert(const std::string &alertId, const std::string &message,
+            const pbnjson::JValue &buttons, const std::string &content);
+    bool dismissAlert(const std::string &alertId);
+    pbnjson::JValue alertClosed(pbnjson::JValue &params);
     void showConnectingToast(int deviceType);
     void showFormatStartedToast(std::string driveInfo);
     void showFormatSuccessToast(std::string driveInfo);
     void showFormatFailToast(std::string driveInfo);
+    pbnjson::JValue dumpFlightRecorder(pbnjson::JValue &params);
+    pbnjson::JValue getMetrics(pbnjson::JValue &params);
+    pbnjson::JValue setTraceRecording(pbnjson::JValue &params);
 private:
+    //Newest update of a list waiting for the coalescing timeout
+    struct PendingDeviceList {
+        PendingDeviceList() :
+                queued(false), startNs(0) {
+        }
+
+        bool queued;
+        pbnjson::JValue previousValue;
+        pbnjson::JValue value;
+        uint64_t startNs;
+    };
+
+    //Newest update of a list the full worker queue could not take yet
+    struct ParkedListJob {
+        ParkedListJob() :
+                queued(false), jobType(DeviceListWorker::JOB_DIFF), startNs(0) {
+        }
+
+        bool queued;
+        DeviceListWorker::JobType jobType;
+        pbnjson::JValue value;
+        uint64_t startNs;
+    };
+
     bool toastsBlocked;
-    std::unordered_map<int, Device> mStorageDevices;
-    std::unordered_map<int, Device> mNonStorageDevices;
-    std::unordered_multimap<int, Device> mNewDevices;
+    DeviceListDiff mStorageDevices;
+    DeviceListDiff mNonStorageDevices;
+    LocaleCatalog mCatalog;
+    ToastMessageCache mToastMessages;
+    AlertTemplates mAlertTemplates;
+    OpenAlerts mOpenAlerts;
+    ToastCoalescer mToastCoalescer;
+    DeviceDebouncer mDebouncer;
+    PdmEventRing mEventRing;
+    PdmEventParser mEventParser;
+    PdmTraceRecorder mTrace;
+    //Newest value of each list, the start of a trace recorded at runtime
+    pbnjson::JValue mLastDeviceLists[2];
+    PdmLegacySegment mLegacySegment;
+    uint64_t mLegacyPayloadsTorn;
+    uint64_t mLegacyPayloadsOversized;
+    int mSignalFd;
+    GSource *mSignalSource;
+    int mSignalPipe[2];
+    GSource *mSignalPipeSource;
+    ClockMs mClock;
+    bool mBooting;
+    uint64_t mBootStartMs;
+    bool mInitialListReceived[2];
+    bool mInitialized;
+    std::string mPendingLocale;
+    std::string mLocale;
+    std::unique_ptr<DeviceListWorker> mListWorker;
+    GSource *mListWorkerSource;
+    PendingDeviceList mPendingLists[2];
+    ParkedListJob mParkedListJobs[2];
+    uint64_t mListUpdatesCollapsed;
 };
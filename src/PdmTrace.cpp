@@ -0,0 +1,137 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PdmTrace.h"
+
+#include "Logging.h"
+#include "PdmUtils.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+PdmTraceRecorder::PdmTraceRecorder(uint64_t maxBytes) :
+        mFd(-1), mMaxBytes(maxBytes), mBytes(0) {
+}
+
+PdmTraceRecorder::~PdmTraceRecorder() {
+    stop();
+}
+
+bool PdmTraceRecorder::start(const std::string &directory, bool atStartup,
+        const pbnjson::JValue &storageList,
+        const pbnjson::JValue &nonStorageList) {
+    stop();
+
+    char name[64];
+    snprintf(name, sizeof(name), "/event-monitor-pdm-%llu.trace",
+            (unsigned long long) PdmUtils::getMonotonicTimeNs());
+    std::string path = directory + name;
+    int fd = open(path.c_str(),
+            O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        LOG_WARNING(MSGID_PDM_PLUGIN_INFO, 0, "Cannot create trace %s",
+                path.c_str());
+        return false;
+    }
+    if (!attach(fd, atStartup ? PDM_TRACE_FLAG_STARTUP : 0)) {
+        unlink(path.c_str());
+        return false;
+    }
+
+    LOG_INFO(MSGID_PDM_PLUGIN_INFO, 0, "Recording trace to %s", path.c_str());
+    mPath = path;
+
+    //The devices attached before recording, a replay starts from them
+    if (!atStartup) {
+        if (!storageList.isNull())
+            recordDeviceList(PDM_TRACE_STORAGE_LIST, pbnjson::JValue(),
+                    storageList);
+        if (!nonStorageList.isNull())
+            recordDeviceList(PDM_TRACE_NONSTORAGE_LIST, pbnjson::JValue(),
+                    nonStorageList);
+    }
+    return recording();
+}
+
+bool PdmTraceRecorder::attach(int fd, uint16_t flags) {
+    stop();
+    if (fd < 0)
+        return false;
+
+    PdmTraceFileHeader header = { PDM_TRACE_MAGIC, PDM_TRACE_VERSION, flags,
+            PdmUtils::getMonotonicTimeNs() };
+    if (::write(fd, &header, sizeof(header)) != sizeof(header)) {
+        close(fd);
+        return false;
+    }
+
+    mPath.clear();
+    mBytes = sizeof(header);
+    mFd.store(fd, std::memory_order_release);
+    return true;
+}
+
+void PdmTraceRecorder::stop() {
+    int fd = mFd.exchange(-1, std::memory_order_acq_rel);
+    if (fd >= 0)
+        close(fd);
+}
+
+void PdmTraceRecorder::recordDeviceList(PdmTraceRecordType type,
+        const pbnjson::JValue &previousValue, const pbnjson::JValue &value) {
+    if (!recording())
+        return;
+
+    //The NUL terminator separates both documents
+    std::string previous = previousValue.stringify();
+    std::string current = value.stringify();
+    write(type, previous.c_str(), previous.size() + 1, current.data(),
+            current.size());
+}
+
+void PdmTraceRecorder::recordPdmEvent(const char *payload, size_t length) {
+    if (!recording())
+        return;
+
+    write(PDM_TRACE_PDM_EVENT, payload, length, nullptr, 0);
+}
+
+void PdmTraceRecorder::write(PdmTraceRecordType type, const char *first,
+        size_t firstLength, const char *second, size_t secondLength) {
+    PdmTraceRecordHeader header = { PdmUtils::getMonotonicTimeNs(),
+            (uint16_t) type, 0, (uint32_t) (firstLength + secondLength) };
+
+    struct iovec parts[3] = { { &header, sizeof(header) }, { (void*) first,
+            firstLength }, { (void*) second, secondLength } };
+    ssize_t expected = sizeof(header) + firstLength + secondLength;
+    if (mBytes + expected > mMaxBytes) {
+        LOG_WARNING(MSGID_PDM_PLUGIN_INFO, 0,
+                "Trace reached its limit of %llu bytes, stopping",
+                (unsigned long long) mMaxBytes);
+        stop();
+        return;
+    }
+
+    int fd = mFd.load(std::memory_order_acquire);
+    if (fd >= 0 && writev(fd, parts, 3) != expected) {
+        LOG_WARNING(MSGID_PDM_PLUGIN_INFO, 0, "Trace write failed, stopping");
+        stop();
+        return;
+    }
+    mBytes += expected;
+}
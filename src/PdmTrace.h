@@ -0,0 +1,106 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <pbnjson.hpp>
+
+#include <atomic>
+#include <string>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Trace of the plugin input, for replaying field captures:
+ *
+ *   PdmTraceFileHeader, then records until end of file.
+ *   Each record is a PdmTraceRecordHeader followed by header.length bytes.
+ *
+ * Device list records hold the stringified previous value, a NUL, and the
+ * stringified value. pdmEvent records hold the payload as received, JSON or
+ * binary. Timestamps are CLOCK_MONOTONIC, startNs is when recording began.
+ *
+ * A trace started at runtime rather than at plugin startup begins with the
+ * device lists current at that time, recorded as first responses, i.e.
+ * with a null previous value.
+ */
+static const uint32_t PDM_TRACE_MAGIC = 0x54444d50; // "PMDT"
+static const uint16_t PDM_TRACE_VERSION = 1;
+
+// Recording began at plugin startup, boot block included
+static const uint16_t PDM_TRACE_FLAG_STARTUP = 0x0001;
+
+struct PdmTraceFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;
+    uint64_t startNs;
+};
+
+enum PdmTraceRecordType {
+    PDM_TRACE_STORAGE_LIST = 1,
+    PDM_TRACE_NONSTORAGE_LIST,
+    PDM_TRACE_PDM_EVENT
+};
+
+struct PdmTraceRecordHeader {
+    uint64_t timestampNs;
+    uint16_t type;
+    uint16_t reserved;
+    uint32_t length;
+};
+
+/*
+ * Appends plugin input to a trace file, one writev() per record. Records
+ * are only written from the main loop, pdm signals are forwarded there.
+ * The descriptor is still handed over atomically, a record sees either
+ * the open file or -1. Recording stops once the file would grow past
+ * maxBytes.
+ */
+class PdmTraceRecorder {
+public:
+    explicit PdmTraceRecorder(uint64_t maxBytes);
+    ~PdmTraceRecorder();
+
+    // Records to a new file in directory, never an existing one. Unless
+    // recording at startup the lists are written as first responses.
+    bool start(const std::string &directory, bool atStartup,
+            const pbnjson::JValue &storageList,
+            const pbnjson::JValue &nonStorageList);
+    // Records to fd, taking ownership of it
+    bool attach(int fd, uint16_t flags = 0);
+    void stop();
+    bool recording() const {
+        return mFd.load(std::memory_order_acquire) >= 0;
+    }
+    const std::string& path() const {
+        return mPath;
+    }
+
+    void recordDeviceList(PdmTraceRecordType type,
+            const pbnjson::JValue &previousValue, const pbnjson::JValue &value);
+    void recordPdmEvent(const char *payload, size_t length);
+
+private:
+    void write(PdmTraceRecordType type, const char *first, size_t firstLength,
+            const char *second, size_t secondLength);
+
+    std::atomic<int> mFd;
+    std::string mPath;
+    uint64_t mMaxBytes;
+    uint64_t mBytes;
+};
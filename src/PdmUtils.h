@@ -16,24 +16,28 @@
 
 #pragma once
 
-#include <unordered_set>
+#include <functional>
 #include <vector>
-#include <map>
 #include <string>
+#include <type_traits>
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
 
 namespace PdmUtils {
-static const char *REMOVE_USB_DEVICE_BEFORE_MOUNT =
+static const char *const REMOVE_USB_DEVICE_BEFORE_MOUNT =
         "After removing, please reconnect the usb device.";
-static const char *USB_STORAGE_DEV_UNSUPPORTED_FS =
+static const char *const USB_STORAGE_DEV_UNSUPPORTED_FS =
         "This USB storage has an unsupported system and cannot be read.";
-static const char *USB_STORAGE_FSCK_TIME_OUT =
-        "Some files may not be recognizable. Do you want to open device name now?";
-static const char *STORAGE_DEV_FORMAT_STARTED = "Formatting {DRIVEINFO}...";
-static const char *STORAGE_DEV_FORMAT_SUCCESS =
-        "Formatting {DRIVEINFO} has been successfully completed.";
-static const char *STORAGE_DEV_FORMAT_FAIL =
-        "Formatting {DRIVEINFO} has not been successfully completed.";
-static const char *MAX_USB_DEVICE_LIMIT_REACHED =
+static const char *const USB_STORAGE_FSCK_TIME_OUT =
+        "Some files may not be recognizable. Do you want to open {DEVICE} now?";
+static const char *const STORAGE_DEV_FORMAT_STARTED = "Formatting {DRIVE}...";
+static const char *const STORAGE_DEV_FORMAT_SUCCESS =
+        "Formatting {DRIVE} has been successfully completed.";
+static const char *const STORAGE_DEV_FORMAT_FAIL =
+        "Formatting {DRIVE} has not been successfully completed.";
+static const char *const MAX_USB_DEVICE_LIMIT_REACHED =
         "Exceeded maximum number of allowable USB storage. You can connect up to 6 USB storages to your device";
 
 //Alert IDs
@@ -78,46 +82,131 @@ enum DeviceEventType {
     UNKNOWN_DEVICE
 };
 
+// Device types reported in the attached device lists, interned once while
+// decoding. DEVICE_TYPE_NONE stands for "no type seen yet".
+enum DeviceType : uint8_t {
+    DEVICE_TYPE_NONE = 0,
+    DEVICE_TYPE_BLUETOOTH,
+    DEVICE_TYPE_HID,
+    DEVICE_TYPE_SOUND,
+    DEVICE_TYPE_USB_STORAGE,
+    DEVICE_TYPE_CAM,
+    DEVICE_TYPE_XPAD,
+    DEVICE_TYPE_MTP,
+    DEVICE_TYPE_PTP,
+    DEVICE_TYPE_CDC,
+    DEVICE_TYPE_UNKNOWN,
+    DEVICE_TYPE_COUNT
+};
+
+enum DeviceStatus : uint8_t {
+    DEVICE_CONNECTED = 0,
+    DEVICE_DISCONNECTED,
+    DEVICE_STATUS_COUNT
+};
+
 //Device details
 struct Device {
-    int deviceNumber;
-    std::string deviceType;
-    std::string deviceStatus;
+    int32_t deviceNumber;
+    DeviceType deviceType;
+    DeviceStatus deviceStatus;
 };
 
-// Event details
-struct Event {
-    EventType type;
-    std::vector<Device> devices;
-    std::unordered_set<int> deviceNums;
-};
+static_assert(std::is_trivially_copyable<Device>::value,
+        "Device must stay a plain record");
+
+// Maps a PDM deviceType string to its enum. Switching on the length first
+// leaves at most a few candidates, so this is a single memcmp in practice.
+inline DeviceType internDeviceType(const char *type, size_t length) {
+#define MATCH(name, value) \
+    if (0 == memcmp(type, name, length)) \
+        return value
 
-void getDeviceTypeString(std::string &text, std::string &deviceType) {
-
-    if (0 == deviceType.compare("BLUETOOTH")) {
-        text = "Bluetooth device";
-    } else if (0 == deviceType.compare("HID")) {
-        text = "HID device";
-    } else if (0 == deviceType.compare("SOUND")) {
-        text = "Sound device";
-    } else if (0 == deviceType.compare("USB_STORAGE")) {
-        text = "Storage device";
-    } else if (0 == deviceType.compare("CAM")) {
-        text = "Camera device";
-    } else if (0 == deviceType.compare("XPAD")) {
-        text = "XPAD device";
-    } else if (0 == deviceType.compare("MTP")) {
-        text = "MTP device";
-    } else if (0 == deviceType.compare("PTP")) {
-        text = "PTP device";
-    } else if (0 == deviceType.compare("CDC")) {
-        text = "USB device";
-    } else {
-        text = "Unknown device";
+    switch (length) {
+    case 0:
+        return DEVICE_TYPE_NONE;
+    case 3:
+        MATCH("HID", DEVICE_TYPE_HID);
+        MATCH("CAM", DEVICE_TYPE_CAM);
+        MATCH("MTP", DEVICE_TYPE_MTP);
+        MATCH("PTP", DEVICE_TYPE_PTP);
+        MATCH("CDC", DEVICE_TYPE_CDC);
+        break;
+    case 4:
+        MATCH("XPAD", DEVICE_TYPE_XPAD);
+        break;
+    case 5:
+        MATCH("SOUND", DEVICE_TYPE_SOUND);
+        break;
+    case 9:
+        MATCH("BLUETOOTH", DEVICE_TYPE_BLUETOOTH);
+        break;
+    case 11:
+        MATCH("USB_STORAGE", DEVICE_TYPE_USB_STORAGE);
+        break;
     }
+    return DEVICE_TYPE_UNKNOWN;
+#undef MATCH
 }
 
-std::string getDeviceTypeString(int deviceType) {
+inline DeviceType internDeviceType(const std::string &type) {
+    return internDeviceType(type.data(), type.size());
+}
+
+inline const char* getDeviceTypeString(DeviceType deviceType) {
+    static const char *const texts[DEVICE_TYPE_COUNT] = {
+            "Unknown device",   // DEVICE_TYPE_NONE
+            "Bluetooth device", // DEVICE_TYPE_BLUETOOTH
+            "HID device",       // DEVICE_TYPE_HID
+            "Sound device",     // DEVICE_TYPE_SOUND
+            "Storage device",   // DEVICE_TYPE_USB_STORAGE
+            "Camera device",    // DEVICE_TYPE_CAM
+            "XPAD device",      // DEVICE_TYPE_XPAD
+            "MTP device",       // DEVICE_TYPE_MTP
+            "PTP device",       // DEVICE_TYPE_PTP
+            "USB device",       // DEVICE_TYPE_CDC
+            "Unknown device"    // DEVICE_TYPE_UNKNOWN
+    };
+    return (deviceType < DEVICE_TYPE_COUNT) ?
+            texts[deviceType] : texts[DEVICE_TYPE_UNKNOWN];
+}
+
+// Whole sentences, so translations are free to order the words
+inline const char* getSummaryToastText(DeviceType deviceType,
+        DeviceStatus deviceStatus) {
+    static const char *const texts[DEVICE_TYPE_COUNT][2] = {
+            { "{COUNT} unknown devices are connected.",
+                    "{COUNT} unknown devices are disconnected." },
+            { "{COUNT} Bluetooth devices are connected.",
+                    "{COUNT} Bluetooth devices are disconnected." },
+            { "{COUNT} HID devices are connected.",
+                    "{COUNT} HID devices are disconnected." },
+            { "{COUNT} sound devices are connected.",
+                    "{COUNT} sound devices are disconnected." },
+            { "{COUNT} storage devices are connected.",
+                    "{COUNT} storage devices are disconnected." },
+            { "{COUNT} camera devices are connected.",
+                    "{COUNT} camera devices are disconnected." },
+            { "{COUNT} XPAD devices are connected.",
+                    "{COUNT} XPAD devices are disconnected." },
+            { "{COUNT} MTP devices are connected.",
+                    "{COUNT} MTP devices are disconnected." },
+            { "{COUNT} PTP devices are connected.",
+                    "{COUNT} PTP devices are disconnected." },
+            { "{COUNT} USB devices are connected.",
+                    "{COUNT} USB devices are disconnected." },
+            { "{COUNT} unknown devices are connected.",
+                    "{COUNT} unknown devices are disconnected." } };
+    if (deviceType >= DEVICE_TYPE_COUNT)
+        deviceType = DEVICE_TYPE_UNKNOWN;
+    return texts[deviceType][deviceStatus == DEVICE_CONNECTED ? 0 : 1];
+}
+
+inline const char* getDeviceStatusString(DeviceStatus deviceStatus) {
+    return (deviceStatus == DEVICE_CONNECTED) ? "connected." : "disconnected.";
+}
+
+inline std::string getDeviceTypeString(int deviceType) {
 
     std::string device;
     switch (deviceType) {
@@ -177,27 +266,38 @@ std::string getDeviceTypeString(int deviceType) {
     return device;
 }
 
-void getToastText(std::string &text, std::string deviceType,
-        std::string deviceStatus) {
-    getDeviceTypeString(text, deviceType);
-    text += (" is " + deviceStatus);
+// Picks the type to report for a device that exposes several interfaces
+inline DeviceType getDominantDeviceType(DeviceType current,
+        DeviceType received) {
+    if (current == DEVICE_TYPE_NONE) {
+        return received;
+    } else if ((current == DEVICE_TYPE_HID) && (received != DEVICE_TYPE_HID)) {
+        return received;
+    } else if ((current == DEVICE_TYPE_SOUND)
+            && (received == DEVICE_TYPE_CAM)) {
+        return received;
+    }
+    return current;
 }
 
-std::string format(std::string text,
-        std::map<std::string, std::string> values) {
-    std::string formatted = std::move(text);
-    if (!values.empty()) {
-        std::string keyInBraces;
+inline void getToastText(std::string &text, DeviceType deviceType,
+        DeviceStatus deviceStatus) {
+    text = getDeviceTypeString(deviceType);
+    text += " is ";
+    text += getDeviceStatusString(deviceStatus);
+}
 
-        for (std::map<std::string, std::string>::iterator it = values.begin();
-                it != values.end(); ++it) {
-            keyInBraces = "{" + it->first + "}";
-            if (formatted.find(keyInBraces) != std::string::npos)
-                formatted.replace(formatted.find(keyInBraces),
-                        keyInBraces.length(), it->second);
-        }
-    }
+inline uint64_t getMonotonicTimeNs() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ull + now.tv_nsec;
+}
 
-    return formatted;
+inline uint64_t getMonotonicTimeMs() {
+    return getMonotonicTimeNs() / 1000000ull;
 }
+
+// Millisecond clock for time based decisions, replaced by the virtual clock
+// of a mock manager in the bench and trace replay
+typedef std::function<uint64_t()> ClockMs;
 } // namespace PdmUtils
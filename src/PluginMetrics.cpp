@@ -0,0 +1,218 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PluginMetrics.h"
+
+using namespace pbnjson;
+using namespace PdmUtils;
+
+PluginMetrics pluginMetrics;
+
+static const char *const latencyNames[LATENCY_COUNT] = { "pdmEventDecode",
+        "pdmEventTotal", "listDecode", "listDiff", "listTotal" };
+
+static const char *const outcomeNames[OUTCOME_COUNT] = { "parseFailure",
+        "incompletePayload", "toastBlocked", "toastIssued", "alertIssued" };
+
+static const char *const startupNames[STARTUP_COUNT] = { "constructor",
+        "sigaction", "localization", "eventRing", "storageSubscription",
+        "nonStorageSubscription", "methods", "firstSnapshot", "deferredInit" };
+
+static const char *const pdmEventNames[] = { "connecting", "maxCountReached",
+        "removeBeforeMount", "removeBeforeMountMtp",
+        "unsupportedFsFormatNeeded", "fsckTimedOut", "formatStarted",
+        "formatSuccess", "formatFail", "removeUnsupportedFs" };
+
+static const char *const deviceTypeNames[DEVICE_TYPE_COUNT] = { "NONE",
+        "BLUETOOTH", "HID", "SOUND", "USB_STORAGE", "CAM", "XPAD", "MTP", "PTP",
+        "CDC", "UNKNOWN" };
+
+static_assert(sizeof(pdmEventNames) / sizeof(pdmEventNames[0])
+        == REMOVE_UNSUPPORTED_FS_EVENT + 1,
+        "pdmEventNames must cover every PdmEventType");
+
+static JValue toJsonNumber(uint64_t value) {
+    return JValue((int64_t) value);
+}
+
+LatencyHistogram::LatencyHistogram() :
+        mCount(0), mSumNs(0), mMaxNs(0) {
+    for (auto &bucket : mBuckets)
+        bucket.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::add(uint64_t ns) {
+    int bucket = ns ? 64 - __builtin_clzll(ns) : 0;
+    if (bucket >= BUCKETS)
+        bucket = BUCKETS - 1;
+
+    mBuckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    mCount.fetch_add(1, std::memory_order_relaxed);
+    mSumNs.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t max = mMaxNs.load(std::memory_order_relaxed);
+    while (ns > max
+            && !mMaxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+        ;
+}
+
+uint64_t LatencyHistogram::count() const {
+    return mCount.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::max() const {
+    return mMaxNs.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::percentile(unsigned int percent) const {
+    uint64_t total = count();
+    if (!total)
+        return 0;
+
+    //Rank of the sample we are looking for, rounded up
+    uint64_t rank = (total * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < BUCKETS; bucket++) {
+        seen += mBuckets[bucket].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            uint64_t upper = bucket ? (1ull << bucket) - 1 : 0;
+            return (upper < max()) ? upper : max();
+        }
+    }
+    return max();
+}
+
+JValue LatencyHistogram::toJson() const {
+    uint64_t samples = count();
+    JValue buckets = JArray { };
+    for (int bucket = 0; bucket < BUCKETS; bucket++) {
+        uint64_t hits = mBuckets[bucket].load(std::memory_order_relaxed);
+        if (hits)
+            buckets.append(JObject { { "log2Ns", bucket }, { "count",
+                    toJsonNumber(hits) } });
+    }
+
+    return JObject { { "count", toJsonNumber(samples) }, { "meanNs",
+            toJsonNumber(
+                    samples ?
+                            mSumNs.load(std::memory_order_relaxed) / samples :
+                            0) }, { "p50Ns", toJsonNumber(percentile(50)) }, {
+            "p99Ns", toJsonNumber(percentile(99)) }, { "maxNs", toJsonNumber(
+            max()) }, { "buckets", buckets } };
+}
+
+PluginMetrics::PluginMetrics() :
+        mTimeToReadyMs(0), mBootTimedOut(false), mBootReady(false) {
+    for (auto &counter : mPdmEvents)
+        counter.store(0, std::memory_order_relaxed);
+    for (auto &counters : mDevices)
+        for (auto &counter : counters)
+            counter.store(0, std::memory_order_relaxed);
+    for (auto &counter : mOutcomes)
+        counter.store(0, std::memory_order_relaxed);
+    for (int stage = 0; stage < STARTUP_COUNT; stage++)
+        mStartupRecorded[stage] = false;
+}
+
+void PluginMetrics::latency(MetricsLatency stage, uint64_t startNs) {
+    mLatency[stage].add(getMonotonicTimeNs() - startNs);
+}
+
+void PluginMetrics::pdmEvent(int pdmEvent) {
+    if (pdmEvent >= 0 && pdmEvent <= REMOVE_UNSUPPORTED_FS_EVENT)
+        mPdmEvents[pdmEvent].fetch_add(1, std::memory_order_relaxed);
+}
+
+void PluginMetrics::device(DeviceType deviceType, DeviceStatus deviceStatus) {
+    if (deviceType < DEVICE_TYPE_COUNT && deviceStatus < DEVICE_STATUS_COUNT)
+        mDevices[deviceType][deviceStatus].fetch_add(1,
+                std::memory_order_relaxed);
+}
+
+void PluginMetrics::outcome(MetricsOutcome outcome) {
+    mOutcomes[outcome].fetch_add(1, std::memory_order_relaxed);
+}
+
+void PluginMetrics::bootReady(uint64_t timeToReadyMs, bool timedOut) {
+    mTimeToReadyMs.store(timeToReadyMs, std::memory_order_relaxed);
+    mBootTimedOut.store(timedOut, std::memory_order_relaxed);
+    mBootReady.store(true, std::memory_order_release);
+}
+
+void PluginMetrics::startupStage(StartupStage stage, uint64_t startNs) {
+    if (mStartupRecorded[stage])
+        return;
+
+    mStartupStartNs[stage] = startNs;
+    mStartupDurationNs[stage] = getMonotonicTimeNs() - startNs;
+    mStartupRecorded[stage] = true;
+}
+
+JValue PluginMetrics::toJson() const {
+    JValue latency = JObject { };
+    for (int stage = 0; stage < LATENCY_COUNT; stage++)
+        latency.put(latencyNames[stage], mLatency[stage].toJson());
+
+    JValue pdmEvents = JObject { };
+    for (int event = 0; event <= REMOVE_UNSUPPORTED_FS_EVENT; event++)
+        pdmEvents.put(pdmEventNames[event],
+                toJsonNumber(mPdmEvents[event].load(std::memory_order_relaxed)));
+
+    JValue devices = JObject { };
+    for (int type = 0; type < DEVICE_TYPE_COUNT; type++) {
+        uint64_t connected = mDevices[type][DEVICE_CONNECTED].load(
+                std::memory_order_relaxed);
+        uint64_t disconnected = mDevices[type][DEVICE_DISCONNECTED].load(
+                std::memory_order_relaxed);
+        if (connected || disconnected)
+            devices.put(deviceTypeNames[type], JObject { { "connected",
+                    toJsonNumber(connected) }, { "disconnected", toJsonNumber(
+                    disconnected) } });
+    }
+
+    JValue outcomes = JObject { };
+    for (int outcome = 0; outcome < OUTCOME_COUNT; outcome++)
+        outcomes.put(outcomeNames[outcome],
+                toJsonNumber(mOutcomes[outcome].load(std::memory_order_relaxed)));
+
+    JValue boot = JObject { { "ready", mBootReady.load(
+            std::memory_order_acquire) } };
+    if (mBootReady.load(std::memory_order_acquire)) {
+        boot.put("timeToReadyMs",
+                toJsonNumber(mTimeToReadyMs.load(std::memory_order_relaxed)));
+        boot.put("timedOut", mBootTimedOut.load(std::memory_order_relaxed));
+    }
+
+    uint64_t startupBaseNs = UINT64_MAX;
+    for (int stage = 0; stage < STARTUP_COUNT; stage++) {
+        if (mStartupRecorded[stage] && mStartupStartNs[stage] < startupBaseNs)
+            startupBaseNs = mStartupStartNs[stage];
+    }
+
+    JValue startup = JObject { };
+    for (int stage = 0; stage < STARTUP_COUNT; stage++) {
+        if (mStartupRecorded[stage])
+            startup.put(startupNames[stage], JObject { { "offsetUs",
+                    toJsonNumber((mStartupStartNs[stage] - startupBaseNs)
+                            / 1000) }, {
+                    "durationUs", toJsonNumber(mStartupDurationNs[stage]
+                            / 1000) } });
+    }
+
+    return JObject { { "latency", latency }, { "pdmEvents", pdmEvents }, {
+            "devices", devices }, { "outcomes", outcomes }, { "boot", boot }, {
+            "startup", startup } };
+}
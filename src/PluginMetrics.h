@@ -0,0 +1,119 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "PdmUtils.h"
+
+#include <pbnjson.hpp>
+
+#include <atomic>
+
+#include <stdint.h>
+
+enum MetricsLatency {
+    LATENCY_PDM_EVENT_DECODE = 0, // payload to PdmEventRecord
+    LATENCY_PDM_EVENT_TOTAL,      // SIGUSR2 to toast/alert issued
+    LATENCY_LIST_DECODE,          // device list JSON to snapshot
+    LATENCY_LIST_DIFF,            // snapshot diff against known devices
+    LATENCY_LIST_TOTAL,           // subscription callback to toasts posted
+    LATENCY_COUNT
+};
+
+enum MetricsOutcome {
+    OUTCOME_PARSE_FAILURE = 0,
+    OUTCOME_INCOMPLETE_PAYLOAD,
+    OUTCOME_TOAST_BLOCKED,
+    OUTCOME_TOAST_ISSUED,
+    OUTCOME_ALERT_ISSUED,
+    OUTCOME_COUNT
+};
+
+enum StartupStage {
+    STARTUP_CONSTRUCTOR = 0,        // instantiatePlugin
+    STARTUP_SIGACTION,              // SIGUSR2 handler, pipe and signalfd
+    STARTUP_LOCALIZATION,           // first UI locale applied
+    STARTUP_EVENT_RING,             // pdm event ring or legacy segment
+    STARTUP_STORAGE_SUBSCRIPTION,   // subscribeToMethod calls
+    STARTUP_NONSTORAGE_SUBSCRIPTION,
+    STARTUP_METHODS,                // luna method registration
+    STARTUP_FIRST_SNAPSHOT,         // first device list callback
+    STARTUP_DEFERRED_INIT,          // setup moved behind the first snapshot
+    STARTUP_COUNT
+};
+
+/*
+ * Latency histogram with power of two buckets, bucket n counts samples in
+ * [2^(n-1), 2^n) ns. Percentiles report the upper bound of their bucket,
+ * so they are accurate to a factor of two.
+ */
+class LatencyHistogram {
+public:
+    static const int BUCKETS = 64;
+
+    LatencyHistogram();
+
+    void add(uint64_t ns);
+    uint64_t count() const;
+    uint64_t max() const;
+    uint64_t percentile(unsigned int percent) const;
+    pbnjson::JValue toJson() const;
+
+private:
+    std::atomic<uint64_t> mBuckets[BUCKETS];
+    std::atomic<uint64_t> mCount;
+    std::atomic<uint64_t> mSumNs;
+    std::atomic<uint64_t> mMaxNs;
+};
+
+/*
+ * Latencies and counters of the event pipeline. Updates are relaxed atomics
+ * so they are cheap and safe from the signal handler.
+ */
+class PluginMetrics {
+public:
+    PluginMetrics();
+
+    // Records the time elapsed since startNs
+    void latency(MetricsLatency stage, uint64_t startNs);
+    void pdmEvent(int pdmEvent);
+    void device(PdmUtils::DeviceType deviceType,
+            PdmUtils::DeviceStatus deviceStatus);
+    void outcome(MetricsOutcome outcome);
+    // Time from startMonitoring until device toasts were enabled, timedOut
+    // if the boot block ran to its upper bound
+    void bootReady(uint64_t timeToReadyMs, bool timedOut);
+    // Records the first run of a startup stage, begun at startNs. Offsets
+    // are reported from the first stage begun.
+    void startupStage(StartupStage stage, uint64_t startNs);
+
+    pbnjson::JValue toJson() const;
+
+private:
+    LatencyHistogram mLatency[LATENCY_COUNT];
+    std::atomic<uint64_t> mPdmEvents[PdmUtils::REMOVE_UNSUPPORTED_FS_EVENT + 1];
+    std::atomic<uint64_t> mDevices[PdmUtils::DEVICE_TYPE_COUNT][PdmUtils::DEVICE_STATUS_COUNT];
+    std::atomic<uint64_t> mOutcomes[OUTCOME_COUNT];
+    std::atomic<uint64_t> mTimeToReadyMs;
+    std::atomic<bool> mBootTimedOut;
+    std::atomic<bool> mBootReady;
+    //Only touched from the main loop
+    uint64_t mStartupStartNs[STARTUP_COUNT];
+    uint64_t mStartupDurationNs[STARTUP_COUNT];
+    bool mStartupRecorded[STARTUP_COUNT];
+};
+
+extern PluginMetrics pluginMetrics;
@@ -0,0 +1,114 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ToastCoalescer.h"
+
+#include "FlightRecorder.h"
+#include "Logging.h"
+#include "PluginMetrics.h"
+
+using namespace PdmUtils;
+
+static const char *const COALESCE_TIMEOUT_ID = "toastCoalesce";
+
+//mLastShownMs of a toast kind not shown yet
+static const uint64_t NEVER_SHOWN = UINT64_MAX;
+
+ToastCoalescer::ToastCoalescer(EventMonitor::Manager *manager,
+        ToastMessageCache &messages, const std::string &iconPath,
+        unsigned int windowMs, unsigned int rateLimitMs, ClockMs clock) :
+        mManager(manager), mMessages(messages), mIconPath(iconPath), mWindowMs(
+                windowMs), mRateLimitMs(rateLimitMs), mClock(std::move(clock)), mWindowOpen(
+                false), mMerged(0), mDropped(0) {
+    mPending.reserve(DEVICE_TYPE_COUNT * DEVICE_STATUS_COUNT);
+    for (int type = 0; type < DEVICE_TYPE_COUNT; type++) {
+        for (int status = 0; status < DEVICE_STATUS_COUNT; status++)
+            mLastShownMs[type][status] = NEVER_SHOWN;
+    }
+}
+
+void ToastCoalescer::post(DeviceType deviceType, DeviceStatus deviceStatus) {
+    if (mWindowMs == 0) {
+        PendingToast toast = { deviceType, deviceStatus, 1 };
+        show(toast);
+        return;
+    }
+
+    for (auto &pending : mPending) {
+        if (pending.deviceType == deviceType
+                && pending.deviceStatus == deviceStatus) {
+            pending.count++;
+            return;
+        }
+    }
+    mPending.push_back( { deviceType, deviceStatus, 1 });
+
+    if (!mWindowOpen) {
+        mWindowOpen = true;
+        mManager->setTimeout(COALESCE_TIMEOUT_ID, mWindowMs, false,
+                [this](const std::string &timeoutId) {
+                    this->flush();
+                });
+    }
+}
+
+void ToastCoalescer::flush() {
+    mWindowOpen = false;
+    for (const auto &pending : mPending)
+        show(pending);
+    mPending.clear();
+    LOG_DEBUG("%s merged: %llu dropped: %llu", __FUNCTION__,
+            (unsigned long long) mMerged, (unsigned long long) mDropped);
+}
+
+void ToastCoalescer::show(const PendingToast &toast) {
+    uint64_t &lastShownMs = mLastShownMs[toast.deviceType][toast.deviceStatus];
+    if (mRateLimitMs) {
+        uint64_t nowMs = mClock();
+        if (lastShownMs != NEVER_SHOWN && nowMs - lastShownMs < mRateLimitMs) {
+            LOG_DEBUG("%s rate limited type %d status %d", __FUNCTION__,
+                    toast.deviceType, toast.deviceStatus);
+            mDropped += toast.count;
+            FLIGHT_RECORD(STAGE_TOAST_SUPPRESSED, toast.deviceType, -1);
+            return;
+        }
+        lastShownMs = nowMs;
+    }
+
+    FLIGHT_RECORD(STAGE_TOAST_ISSUED, toast.deviceType, -1);
+    pluginMetrics.outcome(OUTCOME_TOAST_ISSUED);
+
+    if (toast.count == 1) {
+        mManager->createToast(
+                mMessages.deviceMessage(toast.deviceType, toast.deviceStatus),
+                mIconPath);
+        return;
+    }
+
+    std::string summary;
+    if (!mMessages.summaryMessage(toast.deviceType, toast.deviceStatus,
+            toast.count, summary)) {
+        //Rather one toast per device than English in another locale
+        const std::string &message = mMessages.deviceMessage(toast.deviceType,
+                toast.deviceStatus);
+        for (unsigned int i = 0; i < toast.count; i++)
+            mManager->createToast(message, mIconPath);
+        return;
+    }
+
+    mMerged += toast.count - 1;
+    mManager->createToast(summary, mIconPath);
+}
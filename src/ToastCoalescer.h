@@ -0,0 +1,73 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "PdmUtils.h"
+#include "ToastMessageCache.h"
+
+#include <event-monitor-api/pluginbase.hpp>
+
+#include <vector>
+
+#include <stdint.h>
+
+/*
+ * Collects device toasts for a short window and shows one toast per
+ * (device type, status) when the window closes, a summary toast if several
+ * devices of that kind changed. Toasts of one kind closer together than the
+ * rate limit are dropped. A window of 0 shows toasts right away.
+ */
+class ToastCoalescer {
+public:
+    ToastCoalescer(EventMonitor::Manager *manager, ToastMessageCache &messages,
+            const std::string &iconPath, unsigned int windowMs,
+            unsigned int rateLimitMs, PdmUtils::ClockMs clock);
+
+    void post(PdmUtils::DeviceType deviceType,
+            PdmUtils::DeviceStatus deviceStatus);
+    void flush();
+
+    // Toasts folded into a summary
+    uint64_t merged() const {
+        return mMerged;
+    }
+    // Toasts suppressed by the rate limit
+    uint64_t dropped() const {
+        return mDropped;
+    }
+
+private:
+    struct PendingToast {
+        PdmUtils::DeviceType deviceType;
+        PdmUtils::DeviceStatus deviceStatus;
+        unsigned int count;
+    };
+
+    void show(const PendingToast &toast);
+
+    EventMonitor::Manager *mManager;
+    ToastMessageCache &mMessages;
+    std::string mIconPath;
+    unsigned int mWindowMs;
+    unsigned int mRateLimitMs;
+    PdmUtils::ClockMs mClock;
+    bool mWindowOpen;
+    std::vector<PendingToast> mPending;
+    uint64_t mLastShownMs[PdmUtils::DEVICE_TYPE_COUNT][PdmUtils::DEVICE_STATUS_COUNT];
+    uint64_t mMerged;
+    uint64_t mDropped;
+};
@@ -0,0 +1,116 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ToastMessageCache.h"
+
+#include "Logging.h"
+
+using namespace PdmUtils;
+
+static const char *const formatTexts[FORMAT_MESSAGE_COUNT] = {
+        STORAGE_DEV_FORMAT_STARTED, STORAGE_DEV_FORMAT_SUCCESS,
+        STORAGE_DEV_FORMAT_FAIL };
+
+ToastMessageCache::ToastMessageCache(Localizer localizer,
+        StrictLocalizer strictLocalizer) :
+        mLocalizer(std::move(localizer)), mStrictLocalizer(
+                std::move(strictLocalizer)) {
+    invalidate();
+}
+
+const std::string& ToastMessageCache::deviceMessage(DeviceType deviceType,
+        DeviceStatus deviceStatus) {
+    if (deviceType >= DEVICE_TYPE_COUNT)
+        deviceType = DEVICE_TYPE_UNKNOWN;
+    if (deviceStatus >= DEVICE_STATUS_COUNT)
+        deviceStatus = DEVICE_DISCONNECTED;
+
+    if (!mDeviceMessageValid[deviceType][deviceStatus]) {
+        std::string message;
+        getToastText(message, deviceType, deviceStatus);
+        mDeviceMessages[deviceType][deviceStatus] = mLocalizer(message);
+        mDeviceMessageValid[deviceType][deviceStatus] = true;
+        LOG_DEBUG("%s cached: %s", __FUNCTION__,
+                mDeviceMessages[deviceType][deviceStatus].c_str());
+    }
+    return mDeviceMessages[deviceType][deviceStatus];
+}
+
+bool ToastMessageCache::summaryMessage(DeviceType deviceType,
+        DeviceStatus deviceStatus, unsigned int count, std::string &message) {
+    if (deviceType >= DEVICE_TYPE_COUNT)
+        deviceType = DEVICE_TYPE_UNKNOWN;
+    if (deviceStatus >= DEVICE_STATUS_COUNT)
+        deviceStatus = DEVICE_DISCONNECTED;
+
+    MessageTemplate &summary = mSummaryTemplates[deviceType][deviceStatus];
+    if (!mSummaryTemplateValid[deviceType][deviceStatus]) {
+        std::string localized;
+        mSummaryTranslated[deviceType][deviceStatus] = mStrictLocalizer(
+                getSummaryToastText(deviceType, deviceStatus), localized);
+        summary = MessageTemplate(localized, { "COUNT" });
+        mSummaryTemplateValid[deviceType][deviceStatus] = true;
+    }
+    if (!mSummaryTranslated[deviceType][deviceStatus])
+        return false;
+
+    message = summary.render(std::to_string(count));
+    return true;
+}
+
+const std::string& ToastMessageCache::connectingMessage(int deviceEventType) {
+    if (deviceEventType < 0 || deviceEventType >= CONNECTING_TYPE_COUNT)
+        deviceEventType = UNKNOWN_DEVICE;
+
+    if (!mConnectingMessageValid[deviceEventType]) {
+        std::string message = getDeviceTypeString(deviceEventType)
+                + " is connecting.";
+        mConnectingMessages[deviceEventType] = mLocalizer(message);
+        mConnectingMessageValid[deviceEventType] = true;
+    }
+    return mConnectingMessages[deviceEventType];
+}
+
+std::string ToastMessageCache::formatMessage(FormatMessage formatMessage,
+        const std::string &drive) {
+    if (!mFormatTemplateValid[formatMessage]) {
+        //Localize the template, the translations are keyed by placeholder
+        mFormatTemplates[formatMessage] = MessageTemplate(
+                mLocalizer(formatTexts[formatMessage]), { "DRIVE" });
+        mFormatTemplateValid[formatMessage] = true;
+    }
+    return mFormatTemplates[formatMessage].render(drive);
+}
+
+void ToastMessageCache::prepare() {
+    for (int type = 0; type < DEVICE_TYPE_COUNT; type++) {
+        for (int status = 0; status < DEVICE_STATUS_COUNT; status++)
+            deviceMessage((DeviceType) type, (DeviceStatus) status);
+    }
+}
+
+void ToastMessageCache::invalidate() {
+    for (int type = 0; type < DEVICE_TYPE_COUNT; type++) {
+        for (int status = 0; status < DEVICE_STATUS_COUNT; status++) {
+            mDeviceMessageValid[type][status] = false;
+            mSummaryTemplateValid[type][status] = false;
+        }
+    }
+    for (int type = 0; type < CONNECTING_TYPE_COUNT; type++)
+        mConnectingMessageValid[type] = false;
+    for (int message = 0; message < FORMAT_MESSAGE_COUNT; message++)
+        mFormatTemplateValid[message] = false;
+}
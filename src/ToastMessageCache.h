@@ -0,0 +1,82 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "MessageTemplate.h"
+#include "PdmUtils.h"
+
+#include <functional>
+#include <string>
+
+enum FormatMessage {
+    FORMAT_MESSAGE_STARTED = 0,
+    FORMAT_MESSAGE_SUCCESS,
+    FORMAT_MESSAGE_FAIL,
+    FORMAT_MESSAGE_COUNT
+};
+
+/*
+ * Localized device toast texts. The set of messages is small and fixed,
+ * so each one is localized the first time it is needed and kept until the
+ * UI locale changes.
+ */
+class ToastMessageCache {
+public:
+    typedef std::function<std::string(const std::string &text)> Localizer;
+    // False if there is no translation of text for the UI locale
+    typedef std::function<
+            bool(const std::string &text, std::string &localized)> StrictLocalizer;
+
+    ToastMessageCache(Localizer localizer, StrictLocalizer strictLocalizer);
+
+    // "<type> device is connected." / "... is disconnected."
+    const std::string& deviceMessage(PdmUtils::DeviceType deviceType,
+            PdmUtils::DeviceStatus deviceStatus);
+
+    // "<count> <type> devices are connected." for coalesced toasts, false
+    // if the UI locale has no translation of it
+    bool summaryMessage(PdmUtils::DeviceType deviceType,
+            PdmUtils::DeviceStatus deviceStatus, unsigned int count,
+            std::string &message);
+
+    // "<type> device is connecting." for a PdmUtils::DeviceEventType
+    const std::string& connectingMessage(int deviceEventType);
+
+    // "Formatting <drive>..." and its outcomes
+    std::string formatMessage(FormatMessage formatMessage,
+            const std::string &drive);
+
+    // Localizes the connected and disconnected messages of every type now
+    // rather than on first use
+    void prepare();
+    void invalidate();
+
+private:
+    static const int CONNECTING_TYPE_COUNT = PdmUtils::UNKNOWN_DEVICE + 1;
+
+    Localizer mLocalizer;
+    StrictLocalizer mStrictLocalizer;
+    std::string mDeviceMessages[PdmUtils::DEVICE_TYPE_COUNT][PdmUtils::DEVICE_STATUS_COUNT];
+    bool mDeviceMessageValid[PdmUtils::DEVICE_TYPE_COUNT][PdmUtils::DEVICE_STATUS_COUNT];
+    MessageTemplate mSummaryTemplates[PdmUtils::DEVICE_TYPE_COUNT][PdmUtils::DEVICE_STATUS_COUNT];
+    bool mSummaryTemplateValid[PdmUtils::DEVICE_TYPE_COUNT][PdmUtils::DEVICE_STATUS_COUNT];
+    bool mSummaryTranslated[PdmUtils::DEVICE_TYPE_COUNT][PdmUtils::DEVICE_STATUS_COUNT];
+    std::string mConnectingMessages[CONNECTING_TYPE_COUNT];
+    bool mConnectingMessageValid[CONNECTING_TYPE_COUNT];
+    MessageTemplate mFormatTemplates[FORMAT_MESSAGE_COUNT];
+    bool mFormatTemplateValid[FORMAT_MESSAGE_COUNT];
+};
@@ -0,0 +1,77 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PdmTest.h"
+
+#include "AllocationCounter.h"
+#include "Logging.h"
+
+#include <pbnjson.hpp>
+
+static int evaluations = 0;
+
+static const char* countEvaluation() {
+    evaluations++;
+    return "";
+}
+
+static void setDebugEnabled(bool enabled) {
+    if (!pluginLogContext)
+        PmLogGetContext("pdm-plugin-test", &pluginLogContext);
+    PmLogSetContextLevel(pluginLogContext,
+            enabled ? kPmLogLevel_Debug : kPmLogLevel_Info);
+}
+
+//What the list callbacks log on every update
+static pbnjson::JValue makeDeviceList(int count) {
+    pbnjson::JValue list = pbnjson::JArray { };
+    for (int i = 0; i < count; i++)
+        list.append(pbnjson::JObject { { "deviceNum", i + 1 }, { "deviceType",
+                "USB_STORAGE" } });
+    return pbnjson::JObject { { "storageDeviceList", list } };
+}
+
+PDM_TEST(debugLogSkipsArgumentsWhenDisabled) {
+    setDebugEnabled(false);
+    evaluations = 0;
+    LOG_DEBUG("%s", countEvaluation());
+    PDM_CHECK(evaluations == 0);
+}
+
+PDM_TEST(debugLogSkipsStringifyWhenDisabled) {
+    setDebugEnabled(false);
+    pbnjson::JValue value = makeDeviceList(64);
+
+    uint64_t allocations = AllocationCounter::allocations();
+    LOG_DEBUG("%s value: %s", __FUNCTION__, value.stringify().c_str());
+    PDM_CHECK(AllocationCounter::allocations() == allocations);
+}
+
+#ifndef PDM_DISABLE_DEBUG_LOG
+PDM_TEST(debugLogEvaluatesArgumentsWhenEnabled) {
+    //Shows the checks above can fail at all
+    setDebugEnabled(true);
+    evaluations = 0;
+    pbnjson::JValue value = makeDeviceList(64);
+
+    uint64_t allocations = AllocationCounter::allocations();
+    LOG_DEBUG("%s value: %s", countEvaluation(), value.stringify().c_str());
+    uint64_t allocated = AllocationCounter::allocations() - allocations;
+    setDebugEnabled(false);
+    PDM_CHECK(evaluations == 1);
+    PDM_CHECK(allocated > 0);
+}
+#endif
@@ -0,0 +1,187 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PdmTest.h"
+
+#include "DeviceListDiff.h"
+
+using namespace PdmUtils;
+
+static Device device(int deviceNumber, DeviceType deviceType) {
+    return {deviceNumber, deviceType, DEVICE_CONNECTED};
+}
+
+static bool hasDevice(const std::vector<Device> &devices, int deviceNumber,
+        DeviceType deviceType) {
+    for (const auto &entry : devices) {
+        if (entry.deviceNumber == deviceNumber)
+            return entry.deviceType == deviceType;
+    }
+    return false;
+}
+
+static bool sortedUnique(const std::vector<Device> &devices) {
+    for (size_t i = 1; i < devices.size(); i++) {
+        if (devices[i - 1].deviceNumber >= devices[i].deviceNumber)
+            return false;
+    }
+    return true;
+}
+
+PDM_TEST(diffReportsConnectedAndDisconnected) {
+    DeviceListDiff devices;
+    devices.snapshot() = { device(1, DEVICE_TYPE_USB_STORAGE), device(2,
+            DEVICE_TYPE_HID) };
+    devices.diff();
+    PDM_CHECK(devices.connected().size() == 2);
+    PDM_CHECK(devices.disconnected().empty());
+
+    devices.snapshot() = { device(2, DEVICE_TYPE_HID), device(3,
+            DEVICE_TYPE_CAM) };
+    devices.diff();
+    PDM_CHECK(devices.connected().size() == 1);
+    PDM_CHECK(hasDevice(devices.connected(), 3, DEVICE_TYPE_CAM));
+    PDM_CHECK(devices.disconnected().size() == 1);
+    PDM_CHECK(hasDevice(devices.disconnected(), 1, DEVICE_TYPE_USB_STORAGE));
+    PDM_CHECK(devices.disconnected()[0].deviceStatus == DEVICE_DISCONNECTED);
+    PDM_CHECK(devices.devices().size() == 2);
+}
+
+PDM_TEST(diffSortsReorderedSnapshot) {
+    DeviceListDiff devices;
+    devices.snapshot() = { device(3, DEVICE_TYPE_CAM), device(1,
+            DEVICE_TYPE_USB_STORAGE), device(2, DEVICE_TYPE_HID) };
+    devices.diff();
+    PDM_CHECK(devices.devices().size() == 3);
+    PDM_CHECK(sortedUnique(devices.devices()));
+
+    //Same devices in another order, nothing changed
+    devices.snapshot() = { device(2, DEVICE_TYPE_HID), device(3,
+            DEVICE_TYPE_CAM), device(1, DEVICE_TYPE_USB_STORAGE) };
+    devices.diff();
+    PDM_CHECK(devices.connected().empty());
+    PDM_CHECK(devices.disconnected().empty());
+}
+
+PDM_TEST(diffSortsLargeReversedSnapshot) {
+    DeviceListDiff devices;
+    for (int i = 256; i > 0; i--)
+        devices.snapshot().push_back(device(i, DEVICE_TYPE_USB_STORAGE));
+    devices.diff();
+    PDM_CHECK(devices.devices().size() == 256);
+    PDM_CHECK(devices.connected().size() == 256);
+    PDM_CHECK(sortedUnique(devices.devices()));
+}
+
+PDM_TEST(diffMergesDuplicateInterfaces) {
+    DeviceListDiff devices;
+    //HID gives way to the other interface, whatever order they come in
+    devices.snapshot() = { device(5, DEVICE_TYPE_USB_STORAGE), device(1,
+            DEVICE_TYPE_HID), device(1, DEVICE_TYPE_SOUND), device(5,
+            DEVICE_TYPE_HID) };
+    devices.diff();
+    PDM_CHECK(devices.devices().size() == 2);
+    PDM_CHECK(devices.connected().size() == 2);
+    PDM_CHECK(hasDevice(devices.devices(), 1, DEVICE_TYPE_SOUND));
+    PDM_CHECK(hasDevice(devices.devices(), 5, DEVICE_TYPE_USB_STORAGE));
+}
+
+PDM_TEST(diffKeepsDominantTypeInReportedOrder) {
+    //Of two interfaces neither HID nor SOUND the first one reported wins,
+    //so the sort has to keep interfaces of one device in received order
+    std::vector<Device> interfaces;
+    for (int i = 40; i > 0; i--)
+        interfaces.push_back(device(i, DEVICE_TYPE_MTP));
+    for (int i = 1; i <= 40; i++)
+        interfaces.push_back(device(i, DEVICE_TYPE_USB_STORAGE));
+
+    DeviceListDiff devices;
+    devices.snapshot() = interfaces;
+    devices.diff();
+    PDM_CHECK(devices.devices().size() == 40);
+    for (int i = 1; i <= 40; i++)
+        PDM_CHECK(hasDevice(devices.devices(), i, DEVICE_TYPE_MTP));
+}
+
+PDM_TEST(diffKeepsTypeOfKnownDevice) {
+    DeviceListDiff devices;
+    devices.snapshot() = { device(1, DEVICE_TYPE_MTP) };
+    devices.diff();
+    devices.snapshot() = { device(1, DEVICE_TYPE_PTP) };
+    devices.diff();
+    PDM_CHECK(devices.connected().empty());
+    PDM_CHECK(hasDevice(devices.devices(), 1, DEVICE_TYPE_MTP));
+}
+
+PDM_TEST(diffHandlesEmptyLists) {
+    DeviceListDiff devices;
+    devices.diff();
+    PDM_CHECK(devices.connected().empty());
+    PDM_CHECK(devices.disconnected().empty());
+    PDM_CHECK(devices.devices().empty());
+
+    devices.snapshot() = { device(1, DEVICE_TYPE_USB_STORAGE), device(2,
+            DEVICE_TYPE_USB_STORAGE) };
+    devices.diff();
+    devices.snapshot().clear();
+    devices.diff();
+    PDM_CHECK(devices.connected().empty());
+    PDM_CHECK(devices.disconnected().size() == 2);
+    PDM_CHECK(devices.devices().empty());
+}
+
+PDM_TEST(mergeAddsWithoutReporting) {
+    DeviceListDiff devices;
+    devices.snapshot() = { device(2, DEVICE_TYPE_HID) };
+    devices.merge();
+    devices.snapshot() = { device(1, DEVICE_TYPE_USB_STORAGE), device(2,
+            DEVICE_TYPE_SOUND) };
+    devices.merge();
+    PDM_CHECK(devices.connected().empty());
+    PDM_CHECK(devices.disconnected().empty());
+    PDM_CHECK(devices.devices().size() == 2);
+    PDM_CHECK(hasDevice(devices.devices(), 1, DEVICE_TYPE_USB_STORAGE));
+    PDM_CHECK(hasDevice(devices.devices(), 2, DEVICE_TYPE_SOUND));
+
+    //An empty snapshot keeps what is known
+    devices.snapshot().clear();
+    devices.merge();
+    PDM_CHECK(devices.devices().size() == 2);
+}
+
+PDM_TEST(diffSkipsUnchangedHashedSnapshot) {
+    DeviceListDiff devices;
+    devices.snapshot() = { device(1, DEVICE_TYPE_USB_STORAGE) };
+    devices.setSnapshotHash(1);
+    devices.diff();
+    PDM_CHECK(devices.hashMisses() == 1);
+
+    devices.snapshot() = { device(1, DEVICE_TYPE_USB_STORAGE) };
+    devices.setSnapshotHash(1);
+    devices.diff();
+    PDM_CHECK(devices.hashHits() == 1);
+    PDM_CHECK(devices.connected().empty());
+
+    //Without a hash the full diff runs and the committed hash is dropped
+    devices.snapshot().clear();
+    devices.diff();
+    PDM_CHECK(devices.disconnected().size() == 1);
+    devices.snapshot() = { device(1, DEVICE_TYPE_USB_STORAGE) };
+    devices.setSnapshotHash(1);
+    devices.diff();
+    PDM_CHECK(devices.hashHits() == 1);
+    PDM_CHECK(devices.connected().size() == 1);
+}
@@ -0,0 +1,146 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PdmTest.h"
+
+#include "FlightRecorder.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+//Dumps go to a private directory, removed again by the destructor
+class DumpDir {
+public:
+    DumpDir() {
+        char name[] = "/tmp/pdm-flight-test.XXXXXX";
+        if (mkdtemp(name))
+            mPath = name;
+    }
+
+    ~DumpDir() {
+        unlink(file().c_str());
+        unlink(link().c_str());
+        rmdir(mPath.c_str());
+    }
+
+    std::string file() const {
+        return mPath + "/dump";
+    }
+
+    std::string link() const {
+        return mPath + "/link";
+    }
+
+private:
+    std::string mPath;
+};
+
+static bool readDump(const std::string &path, FlightRecorderFileHeader &header,
+        std::vector<FlightRecorderEntry> &entries) {
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1;
+    if (ok) {
+        entries.resize(header.count);
+        ok = fread(entries.data(), sizeof(FlightRecorderEntry), header.count,
+                file) == header.count;
+    }
+    fclose(file);
+    return ok;
+}
+
+PDM_TEST(flightRecorderDumpsEntriesInOrder) {
+    DumpDir dir;
+    std::unique_ptr<FlightRecorder> recorder(new FlightRecorder());
+    recorder->record(STAGE_SIGNAL_RECEIVED, -1, -1);
+    recorder->record(STAGE_PAYLOAD_DECODED, 3, 7);
+    recorder->record(STAGE_DEVICE_CONNECTED, 1, 7);
+    PDM_CHECK(recorder->dump(dir.file()));
+
+    FlightRecorderFileHeader header;
+    std::vector<FlightRecorderEntry> entries;
+    PDM_CHECK(readDump(dir.file(), header, entries));
+    PDM_CHECK(header.magic == FLIGHT_RECORDER_MAGIC);
+    PDM_CHECK(header.version == FLIGHT_RECORDER_VERSION);
+    PDM_CHECK(header.entrySize == sizeof(FlightRecorderEntry));
+    PDM_CHECK(header.count == 3);
+    PDM_CHECK(entries.size() == 3);
+    PDM_CHECK(entries[0].stage == STAGE_SIGNAL_RECEIVED);
+    PDM_CHECK(entries[1].stage == STAGE_PAYLOAD_DECODED);
+    PDM_CHECK(entries[1].eventType == 3 && entries[1].deviceNum == 7);
+    PDM_CHECK(entries[2].stage == STAGE_DEVICE_CONNECTED);
+    PDM_CHECK(entries[0].sequence < entries[1].sequence);
+    PDM_CHECK(entries[1].timestampNs <= entries[2].timestampNs);
+}
+
+PDM_TEST(flightRecorderKeepsNewestAfterWraparound) {
+    DumpDir dir;
+    std::unique_ptr<FlightRecorder> recorder(new FlightRecorder());
+    const int total = FlightRecorder::CAPACITY + 10;
+    for (int i = 0; i < total; i++)
+        recorder->record(STAGE_PAYLOAD_DECODED, 0, i);
+    PDM_CHECK(recorder->dump(dir.file()));
+
+    FlightRecorderFileHeader header;
+    std::vector<FlightRecorderEntry> entries;
+    PDM_CHECK(readDump(dir.file(), header, entries));
+    PDM_CHECK(header.count == FlightRecorder::CAPACITY);
+    PDM_CHECK(entries.front().deviceNum == 10);
+    PDM_CHECK(entries.back().deviceNum == total - 1);
+    bool ordered = true;
+    for (size_t i = 1; i < entries.size(); i++)
+        ordered = ordered && entries[i].sequence == entries[i - 1].sequence + 1;
+    PDM_CHECK(ordered);
+}
+
+PDM_TEST(flightRecorderRefusesSymlink) {
+    DumpDir dir;
+    std::unique_ptr<FlightRecorder> recorder(new FlightRecorder());
+    recorder->record(STAGE_SIGNAL_RECEIVED, -1, -1);
+    PDM_CHECK(symlink(dir.file().c_str(), dir.link().c_str()) == 0);
+    PDM_CHECK(!recorder->dump(dir.link()));
+    PDM_CHECK(access(dir.file().c_str(), F_OK) != 0);
+}
+
+PDM_TEST(flightRecorderTriggerOnlyMarksDumpPending) {
+    DumpDir dir;
+    std::unique_ptr<FlightRecorder> recorder(new FlightRecorder());
+    recorder->setTrigger(STAGE_PAYLOAD_REJECTED, dir.file(), 60000);
+    recorder->record(STAGE_PAYLOAD_DECODED, 0, 0);
+    PDM_CHECK(!recorder->triggerPending());
+
+    recorder->record(STAGE_PAYLOAD_REJECTED, 0, 0);
+    PDM_CHECK(recorder->triggerPending());
+    PDM_CHECK(access(dir.file().c_str(), F_OK) != 0);
+
+    PDM_CHECK(recorder->dumpTriggered());
+    PDM_CHECK(!recorder->triggerPending());
+    PDM_CHECK(!recorder->dumpTriggered());
+    FlightRecorderFileHeader header;
+    std::vector<FlightRecorderEntry> entries;
+    PDM_CHECK(readDump(dir.file(), header, entries));
+    PDM_CHECK(header.count == 2);
+
+    //Rate limited until the interval has passed
+    recorder->record(STAGE_PAYLOAD_REJECTED, 0, 0);
+    PDM_CHECK(!recorder->triggerPending());
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PdmTest.h"
+
+#include "OpenAlerts.h"
+
+PDM_TEST(openAlertsSkipsUnchangedAlertWithinWindow) {
+    uint64_t nowMs = 1000;
+    OpenAlerts alerts(100, [&nowMs] {
+        return nowMs;
+    });
+    PDM_CHECK(alerts.open("fsck1", "message"));
+    PDM_CHECK(!alerts.open("fsck1", "message"));
+    PDM_CHECK(alerts.open("fsck1", "other message"));
+    PDM_CHECK(alerts.skipped() == 1);
+    PDM_CHECK(alerts.size() == 1);
+}
+
+PDM_TEST(openAlertsExpiresEntries) {
+    uint64_t nowMs = 1000;
+    OpenAlerts alerts(100, [&nowMs] {
+        return nowMs;
+    });
+    PDM_CHECK(alerts.open("fsck1", "message"));
+    nowMs += 99;
+    PDM_CHECK(!alerts.open("fsck1", "message"));
+    nowMs += 1;
+    PDM_CHECK(alerts.open("fsck1", "message"));
+    //Re-creating restarts the window
+    nowMs += 50;
+    PDM_CHECK(!alerts.open("fsck1", "message"));
+}
+
+PDM_TEST(openAlertsForgetsClosedAndClearedAlerts) {
+    uint64_t nowMs = 1000;
+    OpenAlerts alerts(100, [&nowMs] {
+        return nowMs;
+    });
+    PDM_CHECK(alerts.open("fsck1", "message"));
+    alerts.closed("fsck1");
+    PDM_CHECK(!alerts.close("fsck1"));
+    PDM_CHECK(alerts.open("fsck1", "message"));
+
+    PDM_CHECK(alerts.open("fsck2", "message"));
+    alerts.clear();
+    PDM_CHECK(alerts.size() == 0);
+    PDM_CHECK(alerts.open("fsck2", "message"));
+    PDM_CHECK(alerts.close("fsck2"));
+    PDM_CHECK(!alerts.close("fsck2"));
+}
+
+PDM_TEST(openAlertsClosesUnknownAlerts) {
+    uint64_t nowMs = 1000;
+    OpenAlerts alerts(100, [&nowMs] {
+        return nowMs;
+    });
+    //Still on screen from before an event-monitor restart
+    PDM_CHECK(alerts.close("fsck1"));
+    PDM_CHECK(!alerts.close("fsck1"));
+    PDM_CHECK(alerts.skipped() == 1);
+}
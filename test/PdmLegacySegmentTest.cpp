@@ -0,0 +1,130 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PdmTest.h"
+
+#include "PdmLegacySegment.h"
+
+#include <string>
+
+#include <string.h>
+#include <sys/shm.h>
+#include <unistd.h>
+
+static const size_t SEGMENT_SIZE = 4096;
+
+//Plays PDM, owning a segment under a key of this test process
+class PdmSegment {
+public:
+    PdmSegment() :
+            mKey((key_t) (0x50440000 | (getpid() & 0xffff))), mShmId(-1), mMem(
+                    nullptr) {
+    }
+
+    ~PdmSegment() {
+        remove();
+    }
+
+    key_t key() const {
+        return mKey;
+    }
+
+    bool create() {
+        mShmId = shmget(mKey, SEGMENT_SIZE, IPC_CREAT | IPC_EXCL | 0600);
+        if (mShmId == -1)
+            return false;
+        mMem = (char*) shmat(mShmId, nullptr, 0);
+        return mMem != (char*) -1;
+    }
+
+    void write(const std::string &payload) {
+        memcpy(mMem, payload.data(), payload.size());
+    }
+
+    void remove() {
+        if (mShmId == -1)
+            return;
+        shmdt(mMem);
+        shmctl(mShmId, IPC_RMID, nullptr);
+        mShmId = -1;
+        mMem = nullptr;
+    }
+
+private:
+    key_t mKey;
+    int mShmId;
+    char *mMem;
+};
+
+static std::string payloadOf(const PdmLegacySegment &segment) {
+    return std::string(segment.payload().begin(), segment.payload().end());
+}
+
+PDM_TEST(legacySegmentReadsBarePayload) {
+    PdmSegment pdm;
+    PDM_CHECK(pdm.create());
+    PdmLegacySegment segment(pdm.key());
+    pdm.write("first");
+    PDM_CHECK(segment.read(5) == PDM_LEGACY_READ_OK);
+    PDM_CHECK(payloadOf(segment) == "first");
+    pdm.write("again");
+    PDM_CHECK(segment.read(5) == PDM_LEGACY_READ_OK);
+    PDM_CHECK(payloadOf(segment) == "again");
+}
+
+PDM_TEST(legacySegmentFollowsRecreatedSegment) {
+    PdmSegment pdm;
+    PDM_CHECK(pdm.create());
+    PdmLegacySegment segment(pdm.key());
+    pdm.write("before");
+    PDM_CHECK(segment.read(6) == PDM_LEGACY_READ_OK);
+
+    //Same size, while we still have the old one attached
+    pdm.remove();
+    PDM_CHECK(pdm.create());
+    pdm.write("after!");
+    PDM_CHECK(segment.read(6) == PDM_LEGACY_READ_OK);
+    PDM_CHECK(payloadOf(segment) == "after!");
+
+    pdm.remove();
+    PDM_CHECK(segment.read(6) == PDM_LEGACY_READ_NO_SEGMENT);
+}
+
+PDM_TEST(legacySegmentRejectsOversizedPayload) {
+    PdmSegment pdm;
+    PDM_CHECK(pdm.create());
+    PdmLegacySegment segment(pdm.key());
+    PDM_CHECK(segment.read(SEGMENT_SIZE + 1) == PDM_LEGACY_READ_OVERSIZED);
+}
+
+PDM_TEST(legacySegmentChecksGeneration) {
+    PdmSegment pdm;
+    PDM_CHECK(pdm.create());
+    PdmLegacySegment segment(pdm.key());
+
+    PdmLegacySegmentHeader header;
+    header.magic = PDM_LEGACY_SEGMENT_MAGIC;
+    header.generation.store(3);
+    std::string payload((const char*) &header, sizeof(header));
+    pdm.write(payload + "event");
+    PDM_CHECK(segment.read(5) == PDM_LEGACY_READ_TORN);
+
+    header.generation.store(4);
+    payload.assign((const char*) &header, sizeof(header));
+    pdm.write(payload + "event");
+    PDM_CHECK(segment.read(5) == PDM_LEGACY_READ_OK);
+    PDM_CHECK(payloadOf(segment) == "event");
+}
@@ -0,0 +1,47 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdio.h>
+
+/*
+ * Minimal test registry for pdm-plugin-test. PDM_TEST defines a test case
+ * that registers itself, PDM_CHECK reports a failed condition and lets the
+ * test case go on.
+ */
+namespace PdmTest {
+
+typedef void (*TestFunction)();
+
+bool registerTest(const char *name, TestFunction function);
+void fail(const char *file, int line, const char *condition);
+// Runs every registered test case, returns the number that failed
+int runAll(const char *filter);
+
+} // namespace PdmTest
+
+#define PDM_TEST(name) \
+    static void name(); \
+    static bool name##Registered __attribute__((unused)) = \
+            PdmTest::registerTest(#name, name); \
+    static void name()
+
+#define PDM_CHECK(condition) \
+    do { \
+        if (!(condition)) \
+            PdmTest::fail(__FILE__, __LINE__, #condition); \
+    } while (0)
@@ -0,0 +1,56 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PdmTest.h"
+
+#include "ToastMessageCache.h"
+
+using namespace PdmUtils;
+
+static std::string identity(const std::string &text) {
+    return text;
+}
+
+PDM_TEST(summaryMessageRendersWholeSentence) {
+    ToastMessageCache messages(identity,
+            [](const std::string &text, std::string &localized) {
+                localized = text;
+                return true;
+            });
+    std::string message;
+    PDM_CHECK(messages.summaryMessage(DEVICE_TYPE_USB_STORAGE,
+            DEVICE_CONNECTED, 3, message));
+    PDM_CHECK(message == "3 storage devices are connected.");
+}
+
+PDM_TEST(summaryMessageNeedsTranslation) {
+    bool translated = false;
+    ToastMessageCache messages(identity,
+            [&translated](const std::string &text, std::string &localized) {
+                localized = "{COUNT} Speichergeräte sind angeschlossen.";
+                return translated;
+            });
+    std::string message;
+    PDM_CHECK(!messages.summaryMessage(DEVICE_TYPE_USB_STORAGE,
+            DEVICE_CONNECTED, 3, message));
+    PDM_CHECK(message.empty());
+
+    translated = true;
+    messages.invalidate();
+    PDM_CHECK(messages.summaryMessage(DEVICE_TYPE_USB_STORAGE,
+            DEVICE_CONNECTED, 3, message));
+    PDM_CHECK(message == "3 Speichergeräte sind angeschlossen.");
+}
@@ -0,0 +1,72 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PdmTest.h"
+
+#include <string.h>
+
+#include <vector>
+
+struct TestCase {
+    const char *name;
+    PdmTest::TestFunction function;
+};
+
+//Function local, test cases register from static initializers
+static std::vector<TestCase>& testCases() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+static int failedChecks = 0;
+
+namespace PdmTest {
+
+bool registerTest(const char *name, TestFunction function) {
+    testCases().push_back( { name, function });
+    return true;
+}
+
+void fail(const char *file, int line, const char *condition) {
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, condition);
+    failedChecks++;
+}
+
+int runAll(const char *filter) {
+    int failedTests = 0;
+    for (const auto &testCase : testCases()) {
+        if (filter && !strstr(testCase.name, filter))
+            continue;
+
+        int failedBefore = failedChecks;
+        testCase.function();
+        bool passed = (failedChecks == failedBefore);
+        printf("%s %s\n", passed ? "PASS" : "FAIL", testCase.name);
+        if (!passed)
+            failedTests++;
+    }
+    return failedTests;
+}
+
+} // namespace PdmTest
+
+int main(int argc, char *argv[]) {
+    if (argc > 2) {
+        fprintf(stderr, "Usage: %s [FILTER]\n", argv[0]);
+        return 2;
+    }
+    return PdmTest::runAll(argc > 1 ? argv[1] : nullptr) ? 1 : 0;
+}
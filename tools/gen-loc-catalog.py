@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 LG Electronics, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Compile the cppstrings.json files listed in ilibmanifest.json into one
+binary catalog per locale, read at runtime by src/LocaleCatalog.cpp.
+
+Each catalog holds the fully resolved strings of its locale: the root
+strings, overridden by the language strings, overridden by the region
+strings. "en/GB/cppstrings.json" becomes "en-GB.cat", the root file
+becomes "root.cat".
+
+Layout, little endian, all offsets from the start of the file:
+
+    uint32 magic, version, count, buckets, stringsOffset, stringsSize
+    uint32 seeds[buckets]
+    uint32 entries[count][4]    key offset, key length,
+                                value offset, value length
+    char   strings[stringsSize] NUL terminated keys and values
+
+With h = fnv1a(key), a key is found in entry
+mix(h, seeds[mix(h, 0) % buckets]) % count. The index is a minimal
+perfect hash, a lookup hashes the key once and compares one entry.
+"""
+
+import json
+import os
+import struct
+import sys
+
+MAGIC = 0x54414350  # "PCAT"
+VERSION = 1
+HEADER = struct.Struct("<6I")
+ENTRY = struct.Struct("<4I")
+STRINGS_NAME = "cppstrings.json"
+MAX_SEED = 1 << 20
+
+
+def fnv1a(data):
+    value = 2166136261
+    for byte in data:
+        value ^= byte
+        value = (value * 16777619) & 0xffffffff
+    return value
+
+
+def mix(value, seed):
+    """murmur3 finalizer over value ^ seed * golden ratio"""
+    value = (value ^ (seed * 0x9e3779b9)) & 0xffffffff
+    value ^= value >> 16
+    value = (value * 0x85ebca6b) & 0xffffffff
+    value ^= value >> 13
+    value = (value * 0xc2b2ae35) & 0xffffffff
+    value ^= value >> 16
+    return value
+
+
+def build_index(keys):
+    """Returns (seeds, slots), slots[i] being the index into keys stored in
+    entry i."""
+    count = len(keys)
+    if not count:
+        return [], []
+
+    hashes = [fnv1a(key) for key in keys]
+    buckets = max(1, (count + 3) // 4)
+    members = [[] for _ in range(buckets)]
+    for index in range(count):
+        members[mix(hashes[index], 0) % buckets].append(index)
+
+    seeds = [0] * buckets
+    slots = [None] * count
+    #Place the largest buckets first while most entries are still free
+    for bucket in sorted(range(buckets), key=lambda b: -len(members[b])):
+        if not members[bucket]:
+            continue
+        for seed in range(1, MAX_SEED):
+            wanted = [mix(hashes[i], seed) % count for i in members[bucket]]
+            if len(set(wanted)) == len(wanted) and all(
+                    slots[s] is None for s in wanted):
+                break
+        else:
+            raise RuntimeError("no perfect hash seed found")
+        seeds[bucket] = seed
+        for index, slot in zip(members[bucket], wanted):
+            slots[slot] = index
+
+    return seeds, slots
+
+
+def write_catalog(path, strings):
+    keys = [key.encode("utf-8") for key in sorted(strings)]
+    values = [strings[key].encode("utf-8") for key in sorted(strings)]
+    seeds, slots = build_index(keys)
+
+    strings_offset = HEADER.size + 4 * len(seeds) + ENTRY.size * len(keys)
+    pool = bytearray()
+    entries = []
+    for index in slots:
+        key_offset = strings_offset + len(pool)
+        pool += keys[index] + b"\0"
+        value_offset = strings_offset + len(pool)
+        pool += values[index] + b"\0"
+        entries.append((key_offset, len(keys[index]), value_offset,
+                        len(values[index])))
+
+    with open(path + ".tmp", "wb") as catalog:
+        catalog.write(HEADER.pack(MAGIC, VERSION, len(keys), len(seeds),
+                                  strings_offset, len(pool)))
+        catalog.write(struct.pack("<%dI" % len(seeds), *seeds))
+        for entry in entries:
+            catalog.write(ENTRY.pack(*entry))
+        catalog.write(pool)
+    os.replace(path + ".tmp", path)
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write("Usage: %s RESOURCE_DIR OUTPUT_DIR\n" % argv[0])
+        return 2
+
+    resources, output = argv[1], argv[2]
+    with open(os.path.join(resources, "ilibmanifest.json"),
+              encoding="utf-8") as manifest:
+        files = json.load(manifest)["files"]
+
+    #Locale path ("" for root, "en", "en/GB") -> its own strings
+    own = {}
+    for name in files:
+        if os.path.basename(name) != STRINGS_NAME:
+            continue
+        with open(os.path.join(resources, name), encoding="utf-8") as source:
+            own[os.path.dirname(name)] = json.load(source)
+
+    os.makedirs(output, exist_ok=True)
+    for locale in sorted(own):
+        resolved = {}
+        parts = locale.split("/") if locale else []
+        for depth in range(len(parts) + 1):
+            resolved.update(own.get("/".join(parts[:depth]), {}))
+        name = "-".join(parts) if parts else "root"
+        write_catalog(os.path.join(output, name + ".cat"), resolved)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))